@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+
+# Generates curve-tables.inc, the precomputed multiples of G used by uECC.c.
+# Usage: python scripts/gen_tables.py > curve-tables.inc
+
+curves = [
+    # name, p, a, n, num_n_bits, num_bytes, Gx, Gy
+    ("secp160r1",
+     0xffffffffffffffffffffffffffffffff7fffffff,
+     -3,
+     0x0100000000000000000001f4c8f927aed3ca752257,
+     161, 20,
+     0x4a96b5688ef573284664698968c38bb913cbfc82,
+     0x23a628553168947d59dcc912042351377ac5fb32),
+    ("secp192r1",
+     0xfffffffffffffffffffffffffffffffeffffffffffffffff,
+     -3,
+     0xffffffffffffffffffffffff99def836146bc9b1b4d22831,
+     192, 24,
+     0x188da80eb03090f67cbf20eb43a18800f4ff0afd82ff1012,
+     0x07192b95ffc8da78631011ed6b24cdd573f977a11e794811),
+    ("secp224r1",
+     0xffffffffffffffffffffffffffffffff000000000000000000000001,
+     -3,
+     0xffffffffffffffffffffffffffff16a2e0b8f03e13dd29455c5c2a3d,
+     224, 28,
+     0xb70e0cbd6bb4bf7f321390b94a03c1d356c21122343280d6115c1d21,
+     0xbd376388b5f723fb4c22dfe6cd4375a05a07476444d5819985007e34),
+    ("secp256r1",
+     0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff,
+     -3,
+     0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551,
+     256, 32,
+     0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296,
+     0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5),
+    ("secp256k1",
+     0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f,
+     0,
+     0xfffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141,
+     256, 32,
+     0x79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798,
+     0x483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8),
+]
+
+comb_teeth = [2, 3, 4, 5, 6]
+wnaf_windows = [4, 5, 6, 7]
+
+
+def inverse(a, p):
+    return pow(a, p - 2, p)
+
+
+def add(P, Q, p, a):
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0]:
+        if (P[1] + Q[1]) % p == 0:
+            return None
+        l = (3 * P[0] * P[0] + a) * inverse(2 * P[1], p) % p
+    else:
+        l = (Q[1] - P[1]) * inverse(Q[0] - P[0], p) % p
+    x = (l * l - P[0] - Q[0]) % p
+    return (x, (l * (P[0] - x) - P[1]) % p)
+
+
+def mult(k, P, p, a):
+    R = None
+    if k < 0:
+        k = -k
+        P = (P[0], -P[1] % p)
+    while k:
+        if k & 1:
+            R = add(R, P, p, a)
+        P = add(P, P, p, a)
+        k >>= 1
+    return R
+
+
+def words(value, num_bytes):
+    b = [(value >> (8 * i)) & 0xff for i in range(num_bytes)]
+    groups = []
+    i = 0
+    while i < num_bytes:
+        size = 8 if num_bytes - i >= 8 else 4
+        groups.append("BYTES_TO_WORDS_%d(%s)" %
+                      (size, ", ".join("%02X" % c for c in b[i:i + size])))
+        i += size
+    return groups
+
+
+def emit_point(P, num_bytes, last):
+    groups = words(P[0], num_bytes) + words(P[1], num_bytes)
+    out = "    { " + (",\n        ".join(groups)) + " }"
+    if not last:
+        out += ","
+    print(out)
+
+
+def emit_comb(name, p, a, n, num_n_bits, num_bytes, G, teeth):
+    # Entry i is 2^((teeth - 1) * d) * G + sum(+/-2^(t * d) * G) for t < teeth - 1,
+    # where the sign of the t-th term is + if bit t of i is set.
+    spacing = (num_n_bits + teeth) // teeth
+    size = 1 << (teeth - 1)
+    print("static const uECC_word_t G_comb_%s[%d][num_words_%s * 2] = {" % (name, size, name))
+    for i in range(size):
+        k = 1 << ((teeth - 1) * spacing)
+        for t in range(teeth - 1):
+            k += (1 if (i >> t) & 1 else -1) << (t * spacing)
+        assert k % n != 0
+        emit_point(mult(k, G, p, a), num_bytes, i == size - 1)
+    print("};")
+
+
+def emit_wnaf(name, p, a, num_bytes, G, window):
+    # Entry i is (2 * i + 1) * G.
+    size = 1 << (window - 2)
+    print("static const uECC_word_t G_wnaf_%s[%d][num_words_%s * 2] = {" % (name, size, name))
+    for i in range(size):
+        emit_point(mult(2 * i + 1, G, p, a), num_bytes, i == size - 1)
+    print("};")
+
+
+print("/* Copyright 2015, Kenneth MacKay. Licensed under the BSD 2-clause license. */")
+print("")
+print("/* Generated by scripts/gen_tables.py. */")
+print("")
+print("#ifndef _UECC_CURVE_TABLES_H_")
+print("#define _UECC_CURVE_TABLES_H_")
+for (name, p, a, n, num_n_bits, num_bytes, Gx, Gy) in curves:
+    print("")
+    print("#if uECC_SUPPORTS_%s" % name)
+    for teeth in comb_teeth:
+        print("#%s (uECC_G_COMB_TEETH == %d)" % ("if" if teeth == comb_teeth[0] else "elif", teeth))
+        emit_comb(name, p, a, n, num_n_bits, num_bytes, (Gx, Gy), teeth)
+    print("#endif /* uECC_G_COMB_TEETH */")
+    for window in wnaf_windows:
+        print("#%s (uECC_G_WNAF_WINDOW == %d)" % ("if" if window == wnaf_windows[0] else "elif", window))
+        emit_wnaf(name, p, a, num_bytes, (Gx, Gy), window)
+    print("#endif /* uECC_G_WNAF_WINDOW */")
+    print("#endif /* uECC_SUPPORTS_%s */" % name)
+print("")
+print("#endif /* _UECC_CURVE_TABLES_H_ */")
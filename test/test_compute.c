@@ -1,6 +1,7 @@
 /* Copyright 2014, Kenneth MacKay. Licensed under the BSD 2-clause license. */
 
 #include "uECC.h"
+#include "uECC_vli.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -13,6 +14,41 @@ void vli_print(char *str, uint8_t *vli, unsigned int size) {
     printf("\n");
 }
 
+#if uECC_ENABLE_VLI_API
+#define MAX_WORDS (32 / uECC_WORD_SIZE + 1) /* secp160r1 has a 21-byte order */
+
+/* Checks the public key computed for private against uECC_point_mult() of the generator, which
+   does not use the fixed-base comb. Returns 0 if they differ. */
+int check_point_mult_G(uint8_t *private, uint8_t *public, uECC_Curve curve) {
+    uECC_word_t scalar[MAX_WORDS] = {0};
+    uECC_word_t point[MAX_WORDS * 2];
+    uint8_t public_mult[64];
+    unsigned num_bytes = uECC_curve_num_bytes(curve);
+    unsigned num_words = uECC_curve_num_words(curve);
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    memcpy(scalar, private, uECC_curve_num_n_bytes(curve));
+#else
+    uECC_vli_bytesToNative(scalar, private, uECC_curve_num_n_bytes(curve));
+#endif
+    uECC_point_mult(point, uECC_curve_G(curve), scalar, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    memcpy(public_mult, point, num_bytes);
+    memcpy(public_mult + num_bytes, point + num_words, num_bytes);
+#else
+    uECC_vli_nativeToBytes(public_mult, num_bytes, point);
+    uECC_vli_nativeToBytes(public_mult + num_bytes, num_bytes, point + num_words);
+#endif
+    if (memcmp(public, public_mult, num_bytes * 2) != 0) {
+        printf("Public key is not identical to uECC_point_mult() of G!\n");
+        vli_print("Computed public key = ", public, num_bytes * 2);
+        vli_print("Multiplied G =        ", public_mult, num_bytes * 2);
+        return 0;
+    }
+    return 1;
+}
+#endif
+
 int main() {
     int i;
     int success;
@@ -64,6 +100,11 @@ int main() {
                 vli_print("Provided public key = ", public, sizeof(public));
                 vli_print("Private key = ", private, sizeof(private));
             }
+#if uECC_ENABLE_VLI_API
+            if (!check_point_mult_G(private, public_computed, curves[c])) {
+                vli_print("Private key = ", private, sizeof(private));
+            }
+#endif
         }
         
         printf("\n");
@@ -1,6 +1,7 @@
 /* Copyright 2014, Kenneth MacKay. Licensed under the BSD 2-clause license. */
 
 #include "uECC.h"
+#include "uECC_vli.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -11,6 +12,12 @@ void vli_print(uint8_t *vli, unsigned int size) {
     }
 }
 
+#if uECC_KEY_POOL_SIZE
+static void count_watermark(void *context) {
+    ++*(int *)context;
+}
+#endif
+
 int main() {
     int i, c;
     uint8_t private1[32] = {0};
@@ -19,6 +26,18 @@ int main() {
     uint8_t public2[64] = {0};
     uint8_t secret1[32] = {0};
     uint8_t secret2[32] = {0};
+    uECC_PreparedKey prepared;
+    uint8_t batch_public[20 * 64];
+    uint8_t batch_private[20 * 32];
+    uint8_t batch_secret[20 * 32];
+    uint8_t results[20];
+    int public_size, private_size;
+#if uECC_KEY_POOL_SIZE
+    static uECC_KeyPool pool;
+    uint8_t last_public[64];
+    int watermark_calls;
+    unsigned added;
+#endif
     
     const struct uECC_Curve_t * curves[5];
     int num_curves = 0;
@@ -82,8 +101,109 @@ int main() {
                 vli_print(secret2, 32);
                 printf("\n");
             }
+
+            /* The x coordinate of the public key is enough. */
+            if (!uECC_shared_secret_x(public1, private2, secret2, curves[c])) {
+                printf("shared_secret_x() failed\n");
+                return 1;
+            }
+
+            if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+                printf("shared_secret_x() does not match shared_secret()!\n");
+                return 1;
+            }
+
+            if (!uECC_prepare_key(public1, &prepared, curves[c]) ||
+                    !uECC_shared_secret_prepared(&prepared, private2, secret2)) {
+                printf("shared_secret_prepared() failed\n");
+                return 1;
+            }
+
+            if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+                printf("shared_secret_prepared() does not match shared_secret()!\n");
+                return 1;
+            }
         }
         printf("\n");
+
+        public_size = uECC_curve_public_key_size(curves[c]);
+        private_size = uECC_curve_private_key_size(curves[c]);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        /* The batch pads each private key to whole words. */
+        private_size = (private_size + uECC_WORD_SIZE - 1) / uECC_WORD_SIZE * uECC_WORD_SIZE;
+#endif
+        if (!uECC_make_key_batch(batch_public, batch_private, 20, curves[c])) {
+            printf("uECC_make_key_batch() failed\n");
+            return 1;
+        }
+        for (i = 0; i < 20; ++i) {
+            if (!uECC_compute_public_key(batch_private + i * private_size, public1, curves[c]) ||
+                    memcmp(public1, batch_public + i * public_size, public_size) != 0 ||
+                    (i > 0 && memcmp(batch_public + i * public_size,
+                                     batch_public + (i - 1) * public_size, public_size) == 0)) {
+                printf("uECC_make_key_batch() gave a bad key pair %d\n", i);
+                return 1;
+            }
+        }
+
+        /* An invalid public key only fails its own shared secret. */
+        batch_public[5 * public_size] ^= 1;
+        if (uECC_shared_secret_batch(batch_public, private1, 20, batch_secret, results,
+                                     curves[c]) ||
+                results[5] != 0) {
+            printf("uECC_shared_secret_batch() accepted an invalid public key\n");
+            return 1;
+        }
+        for (i = 0; i < 20; ++i) {
+            if (i == 5) {
+                continue;
+            }
+            memset(secret1, 0, sizeof(secret1));
+            memset(secret2, 0, sizeof(secret2));
+            memcpy(secret2, batch_secret + i * (public_size / 2), public_size / 2);
+            if (!results[i] ||
+                    !uECC_shared_secret(batch_public + i * public_size, private1, secret1,
+                                        curves[c]) ||
+                    memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+                printf("uECC_shared_secret_batch() gave a wrong shared secret %d\n", i);
+                return 1;
+            }
+        }
+
+#if uECC_KEY_POOL_SIZE
+        /* Two more keys are taken than the pool holds; those are misses. */
+        watermark_calls = 0;
+        uECC_key_pool_init(&pool, curves[c], 1, &count_watermark, &watermark_calls);
+        added = 0;
+        while ((i = (int)uECC_key_pool_refill(&pool, 1000)) != 0) {
+            added += (unsigned)i;
+        }
+        if (added != uECC_KEY_POOL_SIZE || uECC_key_pool_available(&pool) != added) {
+            printf("uECC_key_pool_refill() did not fill the pool\n");
+            return 1;
+        }
+        memset(last_public, 0, sizeof(last_public));
+        for (i = 0; i < uECC_KEY_POOL_SIZE + 2; ++i) {
+            if (!uECC_key_pool_take(&pool, public1, private1) ||
+                    !uECC_compute_public_key(private1, public2, curves[c]) ||
+                    memcmp(public1, public2, sizeof(public1)) != 0 ||
+                    memcmp(public1, last_public, sizeof(public1)) == 0) {
+                printf("uECC_key_pool_take() gave a bad key pair\n");
+                return 1;
+            }
+            memcpy(last_public, public1, sizeof(public1));
+            uECC_key_pool_release(&pool, private1);
+            if (private1[0] != 0) {
+                printf("uECC_key_pool_release() did not wipe the key\n");
+                return 1;
+            }
+        }
+        if (uECC_key_pool_misses(&pool) != 2 || uECC_key_pool_available(&pool) != 0 ||
+                watermark_calls != (uECC_KEY_POOL_SIZE < 2 ? uECC_KEY_POOL_SIZE + 2 : 4)) {
+            printf("uECC_key_pool_take() gave wrong statistics\n");
+            return 1;
+        }
+#endif
     }
     
     return 0;
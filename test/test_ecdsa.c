@@ -5,12 +5,30 @@
 #include <stdio.h>
 #include <string.h>
 
+/* Runs the jobs of a batch call in reverse order, as a stand-in for a thread pool. */
+static void reverse_executor(uECC_Job_Function job, void *context, unsigned count) {
+    while (count > 0) {
+        job(context, --count);
+    }
+}
+
 int main() {
-    int i, c;
+    int i, c, e;
     uint8_t private[32] = {0};
     uint8_t public[64] = {0};
     uint8_t hash[32] = {0};
     uint8_t sig[64] = {0};
+    uECC_PreparedKey prepared;
+#if uECC_NONCE_POOL_SIZE
+    uECC_NoncePool pool;
+    unsigned added;
+#endif
+    uint8_t batch_public[16 * 64];
+    uint8_t batch_hash[16 * 32];
+    uint8_t batch_sig[16 * 64];
+    uint8_t recovery_ids[16];
+    uint8_t results[16];
+    int size;
 
     const struct uECC_Curve_t * curves[5];
     int num_curves = 0;
@@ -51,8 +69,109 @@ int main() {
                 printf("uECC_verify() failed\n");
                 return 1;
             }
+
+            if (!uECC_prepare_key(public, &prepared, curves[c]) ||
+                    !uECC_verify_prepared(&prepared, hash, sizeof(hash), sig)) {
+                printf("uECC_verify_prepared() failed\n");
+                return 1;
+            }
+            sig[0] ^= 1;
+            if (uECC_verify_prepared(&prepared, hash, sizeof(hash), sig)) {
+                printf("uECC_verify_prepared() accepted a modified signature\n");
+                return 1;
+            }
         }
         printf("\n");
+
+        /* The recovery ids are arbitrary; wrong ones must not change the results. */
+        size = uECC_curve_public_key_size(curves[c]);
+        for (i = 0; i < 16; ++i) {
+            if (!uECC_make_key(batch_public + i * size, private, curves[c]) ||
+                    !uECC_sign(private, batch_public + i * size, 32, batch_sig + i * size,
+                               curves[c])) {
+                printf("uECC_make_key() or uECC_sign() failed\n");
+                return 1;
+            }
+            memcpy(batch_hash + i * 32, batch_public + i * size, 32);
+            recovery_ids[i] = (uint8_t)(i % 3 == 0);
+        }
+        if (!uECC_verify_batch(batch_public, batch_hash, 32, batch_sig, recovery_ids, 16,
+                               results, curves[c]) ||
+                !uECC_verify_batch(batch_public, batch_hash, 32, batch_sig, 0, 16, 0,
+                                   curves[c])) {
+            printf("uECC_verify_batch() failed\n");
+            return 1;
+        }
+        batch_sig[3 * size] ^= 1;
+        batch_hash[12 * 32] ^= 1;
+        for (e = 0; e < 2; ++e) {
+            uECC_set_executor(e ? &reverse_executor : 0, 3);
+            memset(results, 2, sizeof(results));
+            if (uECC_verify_batch(batch_public, batch_hash, 32, batch_sig, recovery_ids, 16,
+                                  results, curves[c])) {
+                printf("uECC_verify_batch() accepted a modified signature\n");
+                return 1;
+            }
+            for (i = 0; i < 16; ++i) {
+                if (results[i] != uECC_verify(batch_public + i * size, batch_hash + i * 32, 32,
+                                              batch_sig + i * size, curves[c])) {
+                    printf("uECC_verify_batch() gave a wrong result for signature %d\n", i);
+                    return 1;
+                }
+            }
+        }
+
+        /* private is the key of the last public key. */
+        for (e = 0; e < 2; ++e) {
+            uECC_set_executor(e ? &reverse_executor : 0, 3);
+            if (!uECC_sign_batch(private, batch_hash, 32, 16, batch_sig, curves[c])) {
+                printf("uECC_sign_batch() failed\n");
+                return 1;
+            }
+            for (i = 0; i < 16; ++i) {
+                if (!uECC_verify(batch_public + 15 * size, batch_hash + i * 32, 32,
+                                 batch_sig + i * size, curves[c])) {
+                    printf("uECC_sign_batch() gave an invalid signature %d\n", i);
+                    return 1;
+                }
+            }
+        }
+        uECC_set_executor(0, 0);
+
+#if uECC_NONCE_POOL_SIZE
+        /* Only the first few signatures use pooled nonces; the others fall back to
+           uECC_sign(). */
+        uECC_nonce_pool_init(&pool, curves[c]);
+        added = 0;
+        while (added < 3 && uECC_nonce_pool_refill(&pool, 3 - added) != 0) {
+            added = uECC_nonce_pool_available(&pool);
+        }
+        if (added != (uECC_NONCE_POOL_SIZE < 3 ? uECC_NONCE_POOL_SIZE : 3)) {
+            printf("uECC_nonce_pool_refill() failed\n");
+            return 1;
+        }
+        for (i = 0; i < 16; ++i) {
+            if (!uECC_sign_from_pool(&pool, private, batch_hash + i * 32, 32,
+                                     batch_sig + i * size) ||
+                    !uECC_verify(batch_public + 15 * size, batch_hash + i * 32, 32,
+                                 batch_sig + i * size, curves[c])) {
+                printf("uECC_sign_from_pool() gave an invalid signature %d\n", i);
+                return 1;
+            }
+        }
+        if (uECC_nonce_pool_available(&pool) != 0) {
+            printf("uECC_sign_from_pool() did not use the pool\n");
+            return 1;
+        }
+        i = 0;
+        while ((added = uECC_nonce_pool_refill(&pool, 1000)) != 0) {
+            i += (int)added;
+        }
+        if (i != uECC_NONCE_POOL_SIZE || uECC_nonce_pool_available(&pool) != uECC_NONCE_POOL_SIZE) {
+            printf("uECC_nonce_pool_refill() did not fill the pool\n");
+            return 1;
+        }
+#endif
     }
     
     return 0;
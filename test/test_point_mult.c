@@ -0,0 +1,210 @@
+/* Copyright 2014, Kenneth MacKay. Licensed under the BSD 2-clause license. */
+
+#include "uECC.h"
+#include "uECC_vli.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if uECC_ENABLE_VLI_API
+
+#define MAX_WORDS (32 / uECC_WORD_SIZE + 1) /* secp160r1 has a 21-byte order */
+#define MAX_POINTS 128 /* above the count where uECC_point_multi_mult() switches to Pippenger */
+
+void vli_print(const char *str, const uECC_word_t *vli, unsigned int num_words) {
+    printf("%s ", str);
+    while (num_words--) {
+        printf("%0*llX ", (int)(uECC_WORD_SIZE * 2), (unsigned long long)vli[num_words]);
+    }
+    printf("\n");
+}
+
+/* sum = sum + point in affine coordinates, where a zero sum is the point at infinity. */
+void add_point(uECC_word_t *sum, const uECC_word_t *point, uECC_Curve curve) {
+    uECC_word_t lambda[MAX_WORDS];
+    uECC_word_t t[MAX_WORDS];
+    uECC_word_t x3[MAX_WORDS];
+    const uECC_word_t *p = uECC_curve_p(curve);
+    wordcount_t num_words = uECC_curve_num_words(curve);
+    uECC_word_t *y = sum + num_words;
+
+    if (uECC_vli_isZero(sum, num_words * 2)) {
+        uECC_vli_set(sum, point, num_words * 2);
+        return;
+    }
+    if (uECC_vli_equal(sum, point, num_words)) {
+        if (!uECC_vli_equal(y, point + num_words, num_words)) {
+            uECC_vli_clear(sum, num_words * 2);
+            return;
+        }
+        /* lambda = (3 * x^2 + a) / (2 * y), with a = -3 except on secp256k1 (a = 0) */
+        uECC_vli_modMult(lambda, sum, sum, p, num_words);
+        uECC_vli_modAdd(t, lambda, lambda, p, num_words);
+        uECC_vli_modAdd(lambda, t, lambda, p, num_words);
+#if uECC_SUPPORTS_secp256k1
+        if (curve != uECC_secp256k1())
+#endif
+        {
+            uECC_vli_clear(t, num_words);
+            t[0] = 3;
+            uECC_vli_modSub(lambda, lambda, t, p, num_words);
+        }
+        uECC_vli_modAdd(t, y, y, p, num_words);
+    } else {
+        uECC_vli_modSub(lambda, point + num_words, y, p, num_words);
+        uECC_vli_modSub(t, point, sum, p, num_words);
+    }
+    uECC_vli_modInv(t, t, p, num_words);
+    uECC_vli_modMult(lambda, lambda, t, p, num_words);
+
+    uECC_vli_modMult(x3, lambda, lambda, p, num_words);
+    uECC_vli_modSub(x3, x3, sum, p, num_words);
+    uECC_vli_modSub(x3, x3, point, p, num_words);
+    uECC_vli_modSub(t, sum, x3, p, num_words);
+    uECC_vli_modMult(t, t, lambda, p, num_words);
+    uECC_vli_modSub(y, t, y, p, num_words);
+    uECC_vli_set(sum, x3, num_words);
+}
+
+/* Checks uECC_point_multi_mult() of the first count points and scalars against the sum of
+   separate uECC_point_mult() results. Returns 0 if they differ. */
+int check_multi_mult(const uECC_word_t *points,
+                     const uECC_word_t *scalars,
+                     unsigned count,
+                     uECC_Curve curve) {
+    uECC_word_t expected[MAX_WORDS * 2] = {0};
+    uECC_word_t product[MAX_WORDS * 2];
+    uECC_word_t result[MAX_WORDS * 2];
+    wordcount_t num_words = uECC_curve_num_words(curve);
+    wordcount_t num_n_words = uECC_curve_num_n_words(curve);
+    unsigned i;
+    int not_infinity;
+
+    for (i = 0; i < count; ++i) {
+        if (!uECC_vli_isZero(scalars + i * num_n_words, num_n_words)) {
+            uECC_point_mult(product, points + i * num_words * 2, scalars + i * num_n_words,
+                            curve);
+            add_point(expected, product, curve);
+        }
+    }
+    not_infinity = uECC_point_multi_mult(result, points, scalars, count, curve);
+    if (not_infinity != !uECC_vli_isZero(expected, num_words * 2) ||
+            !uECC_vli_equal(result, expected, num_words * 2)) {
+        printf("uECC_point_multi_mult() of %u points is incorrect\n", count);
+        vli_print("Expected x =", expected, num_words);
+        vli_print("Result x =  ", result, num_words);
+        return 0;
+    }
+    return 1;
+}
+
+/* Checks uECC_point_mult_batch() of the first count points and scalars against separate
+   uECC_point_mult() calls. Returns 0 if they differ. */
+int check_mult_batch(const uECC_word_t *points,
+                     const uECC_word_t *scalars,
+                     unsigned count,
+                     uECC_Curve curve) {
+    static uECC_word_t results[MAX_POINTS * MAX_WORDS * 2];
+    uECC_word_t expected[MAX_WORDS * 2];
+    wordcount_t num_words = uECC_curve_num_words(curve);
+    wordcount_t num_n_words = uECC_curve_num_n_words(curve);
+    unsigned i;
+
+    uECC_point_mult_batch(results, points, scalars, count, curve);
+    for (i = 0; i < count; ++i) {
+        uECC_point_mult(expected, points + i * num_words * 2, scalars + i * num_n_words, curve);
+        if (!uECC_vli_equal(results + i * num_words * 2, expected, num_words * 2)) {
+            printf("uECC_point_mult_batch() of %u points is incorrect for point %u\n", count, i);
+            vli_print("Expected x =", expected, num_words);
+            vli_print("Result x =  ", results + i * num_words * 2, num_words);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main() {
+    static uECC_word_t points[MAX_POINTS * MAX_WORDS * 2];
+    static uECC_word_t scalars[MAX_POINTS * MAX_WORDS];
+    uECC_word_t k[MAX_WORDS];
+    wordcount_t num_words, num_n_words;
+    unsigned i;
+    int c;
+
+    const struct uECC_Curve_t * curves[5];
+    int num_curves = 0;
+#if uECC_SUPPORTS_secp160r1
+    curves[num_curves++] = uECC_secp160r1();
+#endif
+#if uECC_SUPPORTS_secp192r1
+    curves[num_curves++] = uECC_secp192r1();
+#endif
+#if uECC_SUPPORTS_secp224r1
+    curves[num_curves++] = uECC_secp224r1();
+#endif
+#if uECC_SUPPORTS_secp256r1
+    curves[num_curves++] = uECC_secp256r1();
+#endif
+#if uECC_SUPPORTS_secp256k1
+    curves[num_curves++] = uECC_secp256k1();
+#endif
+
+    printf("Testing uECC_point_multi_mult() and uECC_point_mult_batch()\n");
+    for (c = 0; c < num_curves; ++c) {
+        num_words = uECC_curve_num_words(curves[c]);
+        num_n_words = uECC_curve_num_n_words(curves[c]);
+        for (i = 0; i < MAX_POINTS; ++i) {
+            if (!uECC_generate_random_int(k, uECC_curve_n(curves[c]), num_n_words) ||
+                    !uECC_generate_random_int(scalars + i * num_n_words, uECC_curve_n(curves[c]),
+                                              num_n_words)) {
+                printf("uECC_generate_random_int() failed\n");
+                return 1;
+            }
+            uECC_point_mult(points + i * num_words * 2, uECC_curve_G(curves[c]), k, curves[c]);
+        }
+
+        /* A few points (interleaved), and many points (buckets). */
+        if (!check_multi_mult(points, scalars, 1, curves[c]) ||
+                !check_multi_mult(points, scalars, 3, curves[c]) ||
+                !check_multi_mult(points, scalars, MAX_POINTS, curves[c])) {
+            return 1;
+        }
+
+        /* One point, and one more than the four AVX2 or eight AVX-512 lanes. */
+        if (!check_mult_batch(points, scalars, 1, curves[c]) ||
+                !check_mult_batch(points, scalars, 4, curves[c]) ||
+                !check_mult_batch(points, scalars, 5, curves[c]) ||
+                !check_mult_batch(points, scalars, 8, curves[c]) ||
+                !check_mult_batch(points, scalars, 9, curves[c])) {
+            return 1;
+        }
+
+        /* A zero scalar, whose product is the point at infinity. */
+        uECC_vli_clear(scalars + num_n_words, num_n_words);
+        if (!check_multi_mult(points, scalars, 3, curves[c]) ||
+                !check_multi_mult(points, scalars, MAX_POINTS, curves[c])) {
+            return 1;
+        }
+
+        /* Products that add up to the point at infinity: P * k + P * (n - k). */
+        uECC_vli_set(points + num_words * 2, points, num_words * 2);
+        uECC_vli_sub(scalars + num_n_words, uECC_curve_n(curves[c]), scalars, num_n_words);
+        if (!check_multi_mult(points, scalars, 2, curves[c])) {
+            return 1;
+        }
+        printf(".");
+        fflush(stdout);
+    }
+    printf("\n");
+
+    return 0;
+}
+
+#else
+
+int main() {
+    printf("uECC_ENABLE_VLI_API is not enabled\n");
+    return 0;
+}
+
+#endif /* uECC_ENABLE_VLI_API */
@@ -33,6 +33,42 @@
     #endif
 #endif
 
+/* The AArch64 kernels (asm_arm64.inc) have not been run on AArch64 hardware yet, so they are only
+   used when enabled explicitly. */
+#ifndef uECC_ARM64_USE_ASM
+    #define uECC_ARM64_USE_ASM 0
+#endif
+
+/* MULX (BMI2) and ADCX/ADOX (ADX) kernels are selected at runtime using CPUID, unless
+   the compiler is already targeting processors that support them. */
+#ifndef uECC_X86_64_USE_ADX
+    #if (uECC_PLATFORM == uECC_x86_64) && (defined(__GNUC__) || defined(__clang__))
+        #define uECC_X86_64_USE_ADX 1
+    #else
+        #define uECC_X86_64_USE_ADX 0
+    #endif
+#endif
+
+/* The four-lane AVX2 engine (field_avx2.inc) is used by the batch functions when CPUID reports
+   AVX2, unless the compiler is already targeting processors that support it. */
+#ifndef uECC_X86_64_USE_AVX2
+    #if (uECC_PLATFORM == uECC_x86_64) && (defined(__GNUC__) || defined(__clang__))
+        #define uECC_X86_64_USE_AVX2 1
+    #else
+        #define uECC_X86_64_USE_AVX2 0
+    #endif
+#endif
+
+/* The eight-lane AVX-512 IFMA engine (field_ifma.inc) is used in the same way, and takes over
+   from the AVX2 engine when CPUID reports AVX512F and AVX512IFMA. */
+#ifndef uECC_X86_64_USE_IFMA
+    #if (uECC_PLATFORM == uECC_x86_64) && (defined(__GNUC__) || defined(__clang__))
+        #define uECC_X86_64_USE_IFMA 1
+    #else
+        #define uECC_X86_64_USE_IFMA 0
+    #endif
+#endif
+
 #ifndef uECC_WORD_SIZE
     #if uECC_PLATFORM == uECC_avr
         #define uECC_WORD_SIZE 1
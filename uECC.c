@@ -141,6 +141,48 @@
 #define BITS_TO_WORDS(num_bits) ((num_bits + ((uECC_WORD_SIZE * 8) - 1)) / (uECC_WORD_SIZE * 8))
 #define BITS_TO_BYTES(num_bits) ((num_bits + 7) / 8)
 
+#if uECC_G_COMB_TEETH && (uECC_G_COMB_TEETH < 2 || uECC_G_COMB_TEETH > 6)
+    #error "Unsupported value for uECC_G_COMB_TEETH"
+#endif
+
+#if uECC_G_WNAF_WINDOW && (uECC_G_WNAF_WINDOW < 4 || uECC_G_WNAF_WINDOW > 7)
+    #error "Unsupported value for uECC_G_WNAF_WINDOW"
+#endif
+
+#if uECC_MULT_WINDOW && (uECC_MULT_WINDOW < 2 || uECC_MULT_WINDOW > 6)
+    #error "Unsupported value for uECC_MULT_WINDOW"
+#endif
+
+#if uECC_PREPARED_WINDOW < 4 || uECC_PREPARED_WINDOW > 7
+    #error "Unsupported value for uECC_PREPARED_WINDOW"
+#endif
+
+#if uECC_VERIFY_BATCH_SIZE < 0 || uECC_VERIFY_BATCH_SIZE > 256
+    #error "Unsupported value for uECC_VERIFY_BATCH_SIZE"
+#endif
+
+#if uECC_SIGN_BATCH_SIZE < 0 || uECC_SIGN_BATCH_SIZE > 256
+    #error "Unsupported value for uECC_SIGN_BATCH_SIZE"
+#endif
+
+#if uECC_NONCE_POOL_SIZE < 0 || uECC_NONCE_POOL_SIZE > 1024 || \
+        (uECC_NONCE_POOL_SIZE & (uECC_NONCE_POOL_SIZE - 1))
+    #error "Unsupported value for uECC_NONCE_POOL_SIZE"
+#endif
+
+#if uECC_MAKE_KEY_BATCH_SIZE < 0 || uECC_MAKE_KEY_BATCH_SIZE > 256
+    #error "Unsupported value for uECC_MAKE_KEY_BATCH_SIZE"
+#endif
+
+#if uECC_SHARED_SECRET_BATCH_SIZE < 0 || uECC_SHARED_SECRET_BATCH_SIZE > 256
+    #error "Unsupported value for uECC_SHARED_SECRET_BATCH_SIZE"
+#endif
+
+#if uECC_KEY_POOL_SIZE < 0 || uECC_KEY_POOL_SIZE > 1024 || \
+        (uECC_KEY_POOL_SIZE & (uECC_KEY_POOL_SIZE - 1))
+    #error "Unsupported value for uECC_KEY_POOL_SIZE"
+#endif
+
 struct uECC_Curve_t {
     wordcount_t num_words;
     wordcount_t num_bytes;
@@ -156,9 +198,17 @@ struct uECC_Curve_t {
 #if uECC_SUPPORT_COMPRESSED_POINT
     void (*mod_sqrt)(uECC_word_t *a, uECC_Curve curve);
 #endif
+    void (*mod_inv)(uECC_word_t *result, const uECC_word_t *a, uECC_Curve curve);
     void (*x_side)(uECC_word_t *result, const uECC_word_t *x, uECC_Curve curve);
+#if uECC_G_COMB_TEETH
+    const uECC_word_t *G_comb; /* See EccPoint_mult_G(). */
+#endif
+#if uECC_G_WNAF_WINDOW
+    const uECC_word_t *G_wnaf; /* Odd multiples of G, for uECC_verify(). */
+#endif
 #if (uECC_OPTIMIZATION_LEVEL > 0)
     void (*mmod_fast)(uECC_word_t *result, uECC_word_t *product);
+    uECC_word_t mu_n[uECC_MAX_WORDS]; /* floor(2^(2 * num_n_bits) / n) - 2^num_n_bits */
 #endif
 };
 
@@ -186,6 +236,14 @@ static cmpresult_t uECC_vli_cmp_unsafe(const uECC_word_t *left,
     #include "asm_avr.inc"
 #endif
 
+#if (uECC_PLATFORM == uECC_x86_64)
+    #include "asm_x86_64.inc"
+#endif
+
+#if (uECC_PLATFORM == uECC_arm64) && uECC_ARM64_USE_ASM
+    #include "asm_arm64.inc"
+#endif
+
 #if default_RNG_defined
 static uECC_RNG_Function g_rng_function = &default_RNG;
 #else
@@ -200,6 +258,225 @@ uECC_RNG_Function uECC_get_rng(void) {
     return g_rng_function;
 }
 
+static uECC_Executor g_executor = 0;
+static unsigned g_num_threads = 1;
+
+void uECC_set_executor(uECC_Executor executor, unsigned num_threads) {
+    g_executor = executor;
+    g_num_threads = (num_threads ? num_threads : 1);
+}
+
+uECC_Executor uECC_get_executor(void) {
+    return g_executor;
+}
+
+/* Largest number of items in one part of a batch call, and number of results kept on the stack
+   when a batch call without a results buffer runs on the executor. */
+#define BATCH_MAX_PART 256
+#define BATCH_ROUND 4096
+
+/* Runs items start to start + count - 1 (count <= BATCH_MAX_PART) of the batch call described by
+   args, and sets results[i - start] to 1 if item i succeeded and to 0 otherwise (if results is
+   not 0). Returns 1 if all the items succeeded. Parts of the same call may run at the same time
+   on different threads. */
+typedef int (*batch_part_t)(const void *args, unsigned start, unsigned count, uint8_t *results);
+
+/* Items start to start + count - 1 of a batch call, split into parts of part_size items. */
+typedef struct batch_job_t {
+    batch_part_t part;
+    const void *args;
+    unsigned start;
+    unsigned count;
+    unsigned part_size;
+    uint8_t *results;
+} batch_job_t;
+
+/* Runs part 'index' of the batch job in context (a uECC_Job_Function). The results are gathered on
+   the stack and written out once the part is done, so that parts running at the same time do not
+   keep writing to the same cache lines. */
+static void batch_job(void *context, unsigned index) {
+    const batch_job_t *job = (const batch_job_t *)context;
+    uint8_t results[BATCH_MAX_PART];
+    unsigned start = index * job->part_size;
+    unsigned count = job->count - start;
+    unsigned i;
+
+    count = (count < job->part_size ? count : job->part_size);
+    job->part(job->args, job->start + start, count, results);
+    for (i = 0; i < count; ++i) {
+        job->results[start + i] = results[i];
+    }
+}
+
+/* Runs a batch call of count items on the executor, with at least one part per thread where
+   that keeps the parts within max_part items. */
+static int run_batch_parallel(uECC_Executor executor,
+                              batch_part_t part,
+                              const void *args,
+                              unsigned count,
+                              unsigned max_part,
+                              uint8_t *results) {
+    uint8_t round_results[BATCH_ROUND];
+    batch_job_t job;
+    unsigned i;
+    int all_ok = 1;
+
+    job.part = part;
+    job.args = args;
+    for (job.start = 0; job.start < count; job.start += job.count) {
+        job.count = count - job.start;
+        if (results) {
+            job.results = results + job.start;
+        } else {
+            job.count = (job.count < BATCH_ROUND ? job.count : BATCH_ROUND);
+            job.results = round_results;
+        }
+        job.part_size = (job.count + g_num_threads - 1) / g_num_threads;
+        job.part_size = (job.part_size < max_part ? job.part_size : max_part);
+        executor(&batch_job, &job, (job.count + job.part_size - 1) / job.part_size);
+        for (i = 0; i < job.count; ++i) {
+            all_ok &= (job.results[i] != 0);
+        }
+    }
+    return all_ok;
+}
+
+/* Runs a batch call of count items in parts of at most max_part (<= BATCH_MAX_PART) items, on the
+   executor if one was set. Returns 1 if all the items succeeded. */
+static int run_batch(batch_part_t part,
+                     const void *args,
+                     unsigned count,
+                     unsigned max_part,
+                     uint8_t *results) {
+    uECC_Executor executor = g_executor;
+    unsigned start;
+    unsigned n;
+    int all_ok = 1;
+
+    if (executor && (count > max_part || (count > 1 && g_num_threads > 1))) {
+        return run_batch_parallel(executor, part, args, count, max_part, results);
+    }
+    for (start = 0; start < count; start += n) {
+        n = (count - start < max_part ? count - start : max_part);
+        all_ok &= part(args, start, n, results ? results + start : 0);
+    }
+    return all_ok;
+}
+
+#if uECC_NONCE_POOL_SIZE || uECC_KEY_POOL_SIZE
+
+/* The rings of uECC_NoncePool and uECC_KeyPool are bounded queues that several threads can add to
+   and take from at once: head and tail count the entries ever added and taken, and sequence[i]
+   tells whether slot i is ready to be filled (sequence[i] == position) or taken
+   (sequence[i] == position + 1), so that a thread that claims a slot by advancing head or tail
+   can fill or wipe it before releasing it with pool_store(). With GCC or Clang, the counters use
+   atomic operations; otherwise a pool must only be used from one thread at a time. */
+#if defined(__GNUC__) || defined(__clang__)
+    #define POOL_ATOMICS 1
+#else
+    #define POOL_ATOMICS 0
+#endif
+
+static unsigned pool_load(const unsigned *counter) {
+#if POOL_ATOMICS
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+#else
+    return *counter;
+#endif
+}
+
+static void pool_store(unsigned *counter, unsigned value) {
+#if POOL_ATOMICS
+    __atomic_store_n(counter, value, __ATOMIC_RELEASE);
+#else
+    *counter = value;
+#endif
+}
+
+/* Advances *counter from *expected to *expected + 1 if it still holds *expected, and otherwise
+   loads its current value into *expected. Returns 1 if the counter was advanced. */
+static int pool_advance(unsigned *counter, unsigned *expected) {
+#if POOL_ATOMICS
+    return __atomic_compare_exchange_n(counter, expected, *expected + 1, 1,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+    if (*counter != *expected) {
+        *expected = *counter;
+        return 0;
+    }
+    *counter = *expected + 1;
+    return 1;
+#endif
+}
+
+/* Claims a slot of a ring of size slots to fill (if fill is 1, with counter pointing to head) or
+   to take (if fill is 0, with counter pointing to tail). Returns the slot's position, with
+   *claimed set to 1, or sets *claimed to 0 if the ring is full (or empty). */
+static unsigned pool_claim(unsigned *counter,
+                           const unsigned *sequence,
+                           unsigned size,
+                           int fill,
+                           int *claimed) {
+    unsigned position = pool_load(counter);
+    int difference;
+
+    for (;;) {
+        difference = (int)(pool_load(&sequence[position % size]) - (position + !fill));
+        if (difference == 0) {
+            if (pool_advance(counter, &position)) {
+                *claimed = 1;
+                return position;
+            }
+        } else if (difference < 0) {
+            *claimed = 0;
+            return 0;
+        } else {
+            position = pool_load(counter);
+        }
+    }
+}
+
+#if uECC_KEY_POOL_SIZE
+/* Adds 1 to a statistics counter. */
+static void pool_increment(unsigned *counter) {
+#if POOL_ATOMICS
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+#else
+    ++*counter;
+#endif
+}
+
+static void pool_copy(uint8_t *dst, const uint8_t *src, unsigned num_bytes) {
+    unsigned i;
+    for (i = 0; i < num_bytes; ++i) {
+        dst[i] = src[i];
+    }
+}
+#endif
+
+/* Returns the number of entries in a ring of size slots. */
+static unsigned pool_count(const unsigned *head, const unsigned *tail, unsigned size) {
+    unsigned taken = pool_load(tail);
+    unsigned used = pool_load(head) - taken;
+    return (used < size ? used : size);
+}
+
+#endif /* uECC_NONCE_POOL_SIZE || uECC_KEY_POOL_SIZE */
+
+#if (uECC_NONCE_POOL_SIZE || uECC_KEY_POOL_SIZE || uECC_MAKE_KEY_BATCH_SIZE || \
+     uECC_SIGN_BATCH_SIZE)
+
+/* Overwrites num_bytes bytes of data with zeros, in a way that the compiler cannot leave out. */
+static void pool_wipe(void *data, unsigned num_bytes) {
+    volatile uint8_t *bytes = (volatile uint8_t *)data;
+    unsigned i;
+    for (i = 0; i < num_bytes; ++i) {
+        bytes[i] = 0;
+    }
+}
+
+#endif /* pools and batches */
+
 int uECC_curve_private_key_size(uECC_Curve curve) {
     return BITS_TO_BYTES(curve->num_n_bits);
 }
@@ -564,6 +841,63 @@ uECC_VLI_API void uECC_vli_modSub(uECC_word_t *result,
     }
 }
 
+/* Lazy reduction for the point formulas.
+
+   With uECC_LAZY_REDUCTION, intermediate field values are allowed to be only partially
+   reduced: less than 2^N (N = num_words * uECC_WORD_BITS), but possibly >= p. Since
+   p > 2^(N - 1) whenever p uses the full width of its top word, such values are in
+   [0, 2p). vli_modAdd_lazy() then only needs to correct when the addition carries, and
+   vli_modSub_lazy() needs at most two additions of p to go non-negative. The inputs to
+   modMult_fast/modSquare_fast may be partially reduced, so curve->mmod_fast must
+   accept any product of two values < 2^N:
+
+   secp160r1 (word size 1, 4), secp192r1, secp256r1 and secp256k1 (all word sizes),
+   secp224r1 (word size 1, 4): p fills the top word. The mmod_fast implementations
+   either fold every word of the 2N-word product (secp192r1, secp224r1, secp256r1) or
+   fold the high half twice and then loop on the carry (secp160r1, secp256k1), so
+   their result is correct for any 2N-word product.
+
+   secp160r1, secp224r1 (word size 8): p leaves 32 bits free in the top word, so
+   2^N > 2p. vli_mmod_fast_secp224r1() for 64-bit words ignores product bits above
+   2^448 and requires both inputs to be < 2^224, so for these two curves
+   vli_modAdd_lazy() falls back to a fully reduced uECC_vli_modAdd().
+
+   The point formulas keep every coordinate they return <= p, so lazy values never
+   leave XYcZ_add()/XYcZ_addC()/double_jacobian_*(); the callers see no difference. */
+/* Computes result = (left + right) % p, where left <= p and right <= p.
+   The result is only partially reduced (< 2^N) if the curve allows it. */
+static void vli_modAdd_lazy(uECC_word_t *result,
+                            const uECC_word_t *left,
+                            const uECC_word_t *right,
+                            uECC_Curve curve) {
+    wordcount_t num_words = curve->num_words;
+#if uECC_LAZY_REDUCTION
+    if (curve->p[num_words - 1] & HIGH_BIT_SET) {
+        if (uECC_vli_add(result, left, right, num_words)) {
+            /* left + right <= 2p, so one subtraction is enough. */
+            uECC_vli_sub(result, result, curve->p, num_words);
+        }
+        return;
+    }
+#endif
+    uECC_vli_modAdd(result, left, right, curve->p, num_words);
+}
+
+/* Computes result = (left - right) % p, where left and right may be partially
+   reduced. The result is < 2^N, and <= p if left <= p. */
+static void vli_modSub_lazy(uECC_word_t *result,
+                            const uECC_word_t *left,
+                            const uECC_word_t *right,
+                            uECC_Curve curve) {
+    wordcount_t num_words = curve->num_words;
+    if (uECC_vli_sub(result, left, right, num_words)) {
+        /* left - right >= -2p, so at most two additions are needed. */
+        if (!uECC_vli_add(result, result, curve->p, num_words)) {
+            uECC_vli_add(result, result, curve->p, num_words);
+        }
+    }
+}
+
 /* Computes result = product % mod, where product is 2N words long. */
 /* Currently only designed to work for curve_p or curve_n. */
 uECC_VLI_API void uECC_vli_mmod(uECC_word_t *result,
@@ -624,6 +958,11 @@ uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
                                         const uECC_word_t *right,
                                         uECC_Curve curve) {
     uECC_word_t product[2 * uECC_MAX_WORDS];
+#if asm_mult_mmod_fast
+    if (vli_mult_mmod_fast(result, left, right, curve)) {
+        return;
+    }
+#endif
     uECC_vli_mult(product, left, right, curve->num_words);
 #if (uECC_OPTIMIZATION_LEVEL > 0)
     curve->mmod_fast(result, product);
@@ -632,6 +971,78 @@ uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
 #endif
 }
 
+#if (uECC_OPTIMIZATION_LEVEL > 0)
+/* Computes result = src >> shift, where src has at least shift / uECC_WORD_BITS + num_words + 1
+   words (or exactly shift / uECC_WORD_BITS + num_words if shift is a multiple of the word size).
+   result may overlap src. */
+static void vli_rshift_bits(uECC_word_t *result,
+                            const uECC_word_t *src,
+                            bitcount_t shift,
+                            wordcount_t num_words) {
+    wordcount_t word_shift = shift >> uECC_WORD_BITS_SHIFT;
+    bitcount_t bit_shift = shift & uECC_WORD_BITS_MASK;
+    wordcount_t i;
+
+    for (i = 0; i < num_words; ++i) {
+        result[i] = src[i + word_shift];
+        if (bit_shift) {
+            result[i] = (result[i] >> bit_shift) |
+                (src[i + word_shift + 1] << (uECC_WORD_BITS - bit_shift));
+        }
+    }
+}
+
+/* Computes result = product % curve_n using Barrett reduction, where product < n * 2^m
+   (m = num_n_bits). This holds for the product of a value < 2^m and a value < n.
+   Runs in constant time. Note that product is modified. */
+static void vli_mmod_n(uECC_word_t *result, uECC_word_t *product, uECC_Curve curve) {
+    uECC_word_t q[uECC_MAX_WORDS];
+    uECC_word_t tmp[2 * uECC_MAX_WORDS];
+    uECC_word_t *v[2] = {tmp, product};
+    uECC_word_t v_high[2];
+    uECC_word_t index = 1;
+    uECC_word_t borrow;
+    bitcount_t num_n_bits = curve->num_n_bits;
+    wordcount_t num_n_words = BITS_TO_WORDS(num_n_bits);
+    wordcount_t i;
+
+    /* q = floor(floor(product / 2^m) * mu / 2^m), where mu = floor(2^2m / n) = 2^m + mu_n.
+       This is at most 3 less than floor(product / n). */
+    vli_rshift_bits(q, product, num_n_bits, num_n_words);
+    uECC_vli_mult(tmp, q, curve->mu_n, num_n_words);
+    vli_rshift_bits(tmp, tmp, num_n_bits, num_n_words);
+    uECC_vli_add(q, q, tmp, num_n_words);
+
+    /* product = product - q * n < 4n, which may need one word more than n. */
+    uECC_vli_mult(tmp, q, curve->n, num_n_words);
+    borrow = uECC_vli_sub(product, product, tmp, num_n_words);
+    v_high[1] = product[num_n_words] - tmp[num_n_words] - borrow;
+
+    /* Subtract n (up to) three times. */
+    for (i = 0; i < 3; ++i) {
+        borrow = uECC_vli_sub(v[1 - index], v[index], curve->n, num_n_words);
+        v_high[1 - index] = v_high[index] - borrow;
+        index = !(index ^ (v_high[index] < borrow)); /* Swap the index if there was no borrow */
+    }
+    uECC_vli_set(result, v[index], num_n_words);
+}
+#endif /* (uECC_OPTIMIZATION_LEVEL > 0) */
+
+/* Computes result = (left * right) % curve_n, where left < 2^num_n_bits and right < n. */
+static void vli_modMult_n(uECC_word_t *result,
+                          const uECC_word_t *left,
+                          const uECC_word_t *right,
+                          uECC_Curve curve) {
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+#if (uECC_OPTIMIZATION_LEVEL > 0)
+    uECC_word_t product[2 * uECC_MAX_WORDS];
+    uECC_vli_mult(product, left, right, num_n_words);
+    vli_mmod_n(result, product, curve);
+#else
+    uECC_vli_modMult(result, left, right, curve->n, num_n_words);
+#endif
+}
+
 #if uECC_SQUARE_FUNC
 
 #if uECC_ENABLE_VLI_API
@@ -677,6 +1088,250 @@ uECC_VLI_API void uECC_vli_modSquare_fast(uECC_word_t *result,
 
 #endif /* uECC_SQUARE_FUNC */
 
+#if uECC_SAFEGCD_INVERSE && \
+    ((uECC_WORD_SIZE == 4) || ((uECC_WORD_SIZE == 8) && SUPPORTS_INT128))
+#define SAFEGCD_INVERSE 1
+
+/* Constant-time modular inversion using the "safegcd" divsteps algorithm.
+   See "Fast constant-time gcd computation and modular inversion" (Bernstein, Yang), and the
+   write-up in libsecp256k1 (doc/safegcd_implementation.md).
+
+   Values are held as signed limbs of SGCD_LIMB_BITS bits (the top limb holds the sign and any
+   excess bits), and divsteps are processed SGCD_LIMB_BITS at a time using only the bottom
+   limbs of f and g. */
+#if (uECC_WORD_SIZE == 8)
+typedef int64_t sgcd_limb_t;
+typedef uint64_t sgcd_ulimb_t;
+typedef __int128 sgcd_dlimb_t;
+#define SGCD_LIMB_BITS 62
+#else
+typedef int32_t sgcd_limb_t;
+typedef uint32_t sgcd_ulimb_t;
+typedef int64_t sgcd_dlimb_t;
+#define SGCD_LIMB_BITS 30
+#endif
+
+#define SGCD_LIMB_MASK ((sgcd_ulimb_t)-1 >> (uECC_WORD_BITS - SGCD_LIMB_BITS))
+#define SGCD_SIGN_SHIFT (uECC_WORD_BITS - 1)
+#define SGCD_MAX_LIMBS ((uECC_MAX_WORDS * uECC_WORD_BITS + 1) / SGCD_LIMB_BITS + 1)
+
+/* Transition matrix for SGCD_LIMB_BITS divsteps, scaled by 2^SGCD_LIMB_BITS. */
+typedef struct {
+    sgcd_limb_t u, v;
+    sgcd_limb_t q, r;
+} sgcd_matrix_t;
+
+/* Performs SGCD_LIMB_BITS divsteps on the bottom bits of f (odd) and g, and computes the
+   transition matrix t such that 2^SGCD_LIMB_BITS * [f', g'] = t * [f, g]. Returns the new delta.
+   Matrix entries are computed modulo 2^uECC_WORD_BITS; all of them fit in a signed limb. */
+static int sgcd_divsteps(int delta, sgcd_ulimb_t f, sgcd_ulimb_t g, sgcd_matrix_t *t) {
+    sgcd_ulimb_t u = 1, v = 0, q = 0, r = 1;
+    sgcd_ulimb_t odd, swap, x;
+    int i;
+
+    for (i = 0; i < SGCD_LIMB_BITS; ++i) {
+        odd = -(g & 1);
+        swap = odd & -(sgcd_ulimb_t)(delta > 0);
+
+        /* If delta > 0 and g is odd: (delta, f, g) = (-delta, g, -f). */
+        x = (f ^ g) & swap;
+        f ^= x;
+        g ^= x;
+        g = (g ^ swap) - swap;
+        x = (u ^ q) & swap;
+        u ^= x;
+        q ^= x;
+        q = (q ^ swap) - swap;
+        x = (v ^ r) & swap;
+        v ^= x;
+        r ^= x;
+        r = (r ^ swap) - swap;
+        delta = (delta ^ -(int)(swap & 1)) + (int)(swap & 1);
+
+        /* If g is odd: g = g + f. Then g = g / 2. */
+        g += f & odd;
+        q += u & odd;
+        r += v & odd;
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+        ++delta;
+    }
+    t->u = (sgcd_limb_t)u;
+    t->v = (sgcd_limb_t)v;
+    t->q = (sgcd_limb_t)q;
+    t->r = (sgcd_limb_t)r;
+    return delta;
+}
+
+/* Computes [f, g] = t * [f, g] / 2^SGCD_LIMB_BITS. The division is exact. */
+static void sgcd_update_fg(sgcd_limb_t *f,
+                           sgcd_limb_t *g,
+                           const sgcd_matrix_t *t,
+                           wordcount_t num_limbs) {
+    sgcd_dlimb_t cf = (sgcd_dlimb_t)t->u * f[0] + (sgcd_dlimb_t)t->v * g[0];
+    sgcd_dlimb_t cg = (sgcd_dlimb_t)t->q * f[0] + (sgcd_dlimb_t)t->r * g[0];
+    wordcount_t i;
+
+    cf >>= SGCD_LIMB_BITS;
+    cg >>= SGCD_LIMB_BITS;
+    for (i = 1; i < num_limbs; ++i) {
+        cf += (sgcd_dlimb_t)t->u * f[i] + (sgcd_dlimb_t)t->v * g[i];
+        cg += (sgcd_dlimb_t)t->q * f[i] + (sgcd_dlimb_t)t->r * g[i];
+        f[i - 1] = (sgcd_limb_t)(cf & SGCD_LIMB_MASK);
+        g[i - 1] = (sgcd_limb_t)(cg & SGCD_LIMB_MASK);
+        cf >>= SGCD_LIMB_BITS;
+        cg >>= SGCD_LIMB_BITS;
+    }
+    f[num_limbs - 1] = (sgcd_limb_t)cf;
+    g[num_limbs - 1] = (sgcd_limb_t)cg;
+}
+
+/* Computes [d, e] = (t * [d, e] + mod * [md, me]) / 2^SGCD_LIMB_BITS, where md and me are chosen
+   to make the division exact. If d and e are in (-2 * mod, mod), so is the result.
+   mod_inv is 1 / mod modulo 2^SGCD_LIMB_BITS. */
+static void sgcd_update_de(sgcd_limb_t *d,
+                           sgcd_limb_t *e,
+                           const sgcd_matrix_t *t,
+                           const sgcd_limb_t *mod,
+                           sgcd_ulimb_t mod_inv,
+                           wordcount_t num_limbs) {
+    sgcd_limb_t sd = d[num_limbs - 1] >> SGCD_SIGN_SHIFT;
+    sgcd_limb_t se = e[num_limbs - 1] >> SGCD_SIGN_SHIFT;
+    /* Start with md = u and me = q if d is negative, plus v and r if e is negative. */
+    sgcd_limb_t md = (t->u & sd) + (t->v & se);
+    sgcd_limb_t me = (t->q & sd) + (t->r & se);
+    sgcd_dlimb_t cd = (sgcd_dlimb_t)t->u * d[0] + (sgcd_dlimb_t)t->v * e[0];
+    sgcd_dlimb_t ce = (sgcd_dlimb_t)t->q * d[0] + (sgcd_dlimb_t)t->r * e[0];
+    wordcount_t i;
+
+    /* Correct md and me so that the bottom SGCD_LIMB_BITS bits become zero. */
+    md -= (sgcd_limb_t)((mod_inv * (sgcd_ulimb_t)cd + (sgcd_ulimb_t)md) & SGCD_LIMB_MASK);
+    me -= (sgcd_limb_t)((mod_inv * (sgcd_ulimb_t)ce + (sgcd_ulimb_t)me) & SGCD_LIMB_MASK);
+    cd += (sgcd_dlimb_t)mod[0] * md;
+    ce += (sgcd_dlimb_t)mod[0] * me;
+    cd >>= SGCD_LIMB_BITS;
+    ce >>= SGCD_LIMB_BITS;
+    for (i = 1; i < num_limbs; ++i) {
+        cd += (sgcd_dlimb_t)t->u * d[i] + (sgcd_dlimb_t)t->v * e[i] + (sgcd_dlimb_t)mod[i] * md;
+        ce += (sgcd_dlimb_t)t->q * d[i] + (sgcd_dlimb_t)t->r * e[i] + (sgcd_dlimb_t)mod[i] * me;
+        d[i - 1] = (sgcd_limb_t)(cd & SGCD_LIMB_MASK);
+        e[i - 1] = (sgcd_limb_t)(ce & SGCD_LIMB_MASK);
+        cd >>= SGCD_LIMB_BITS;
+        ce >>= SGCD_LIMB_BITS;
+    }
+    d[num_limbs - 1] = (sgcd_limb_t)cd;
+    e[num_limbs - 1] = (sgcd_limb_t)ce;
+}
+
+static void sgcd_carry(sgcd_limb_t *r, wordcount_t num_limbs) {
+    wordcount_t i;
+    for (i = 0; i < num_limbs - 1; ++i) {
+        r[i + 1] += r[i] >> SGCD_LIMB_BITS;
+        r[i] &= SGCD_LIMB_MASK;
+    }
+}
+
+/* Computes r = r * sign(sign) % mod, where r is in (-2 * mod, mod), in constant time. */
+static void sgcd_normalize(sgcd_limb_t *r,
+                           sgcd_limb_t sign,
+                           const sgcd_limb_t *mod,
+                           wordcount_t num_limbs) {
+    sgcd_limb_t add = r[num_limbs - 1] >> SGCD_SIGN_SHIFT;
+    sgcd_limb_t negate = sign >> SGCD_SIGN_SHIFT;
+    wordcount_t i;
+
+    for (i = 0; i < num_limbs; ++i) {
+        r[i] += mod[i] & add;
+        r[i] = (r[i] ^ negate) - negate;
+    }
+    sgcd_carry(r, num_limbs);
+
+    add = r[num_limbs - 1] >> SGCD_SIGN_SHIFT;
+    for (i = 0; i < num_limbs; ++i) {
+        r[i] += mod[i] & add;
+    }
+    sgcd_carry(r, num_limbs);
+}
+
+/* Since SGCD_LIMB_BITS is uECC_WORD_BITS - 2, each word spans at most two limbs (for the
+   supported sizes) and each limb spans at most two words. */
+static void sgcd_from_vli(sgcd_limb_t *limbs,
+                          const uECC_word_t *vli,
+                          wordcount_t num_words,
+                          wordcount_t num_limbs) {
+    wordcount_t i;
+    for (i = 0; i < num_limbs; ++i) {
+        limbs[i] = 0;
+    }
+    for (i = 0; i < num_words; ++i) {
+        bitcount_t bit = (bitcount_t)i * uECC_WORD_BITS;
+        wordcount_t limb = bit / SGCD_LIMB_BITS;
+        bitcount_t shift = bit % SGCD_LIMB_BITS;
+        limbs[limb] |= (sgcd_limb_t)(((sgcd_ulimb_t)vli[i] << shift) & SGCD_LIMB_MASK);
+        limbs[limb + 1] |= (sgcd_limb_t)((sgcd_ulimb_t)vli[i] >> (SGCD_LIMB_BITS - shift));
+    }
+}
+
+static void sgcd_to_vli(uECC_word_t *vli, const sgcd_limb_t *limbs, wordcount_t num_words) {
+    wordcount_t i;
+    for (i = 0; i < num_words; ++i) {
+        bitcount_t bit = (bitcount_t)i * uECC_WORD_BITS;
+        wordcount_t limb = bit / SGCD_LIMB_BITS;
+        bitcount_t shift = bit % SGCD_LIMB_BITS;
+        vli[i] = (uECC_word_t)((sgcd_ulimb_t)limbs[limb] >> shift) |
+            (uECC_word_t)((sgcd_ulimb_t)limbs[limb + 1] << (SGCD_LIMB_BITS - shift));
+    }
+}
+
+/* Computes result = (1 / input) % mod in constant time. All VLIs are the same size.
+   mod must be odd. Returns 0 if input is 0. */
+uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
+                                  const uECC_word_t *input,
+                                  const uECC_word_t *mod,
+                                  wordcount_t num_words) {
+    sgcd_limb_t f[SGCD_MAX_LIMBS], g[SGCD_MAX_LIMBS];
+    sgcd_limb_t d[SGCD_MAX_LIMBS], e[SGCD_MAX_LIMBS];
+    sgcd_limb_t m[SGCD_MAX_LIMBS];
+    sgcd_matrix_t t;
+    sgcd_ulimb_t mod_inv;
+    int num_bits = num_words * uECC_WORD_BITS;
+    /* Number of divsteps that is always enough for num_bits-bit inputs (Bernstein, Yang,
+       theorem 11.2). */
+    int num_steps = (49 * num_bits + 80) / 17;
+    wordcount_t num_limbs = (num_bits + 1) / SGCD_LIMB_BITS + 1;
+    int delta = 1;
+    int i;
+
+    sgcd_from_vli(m, mod, num_words, num_limbs);
+    sgcd_from_vli(f, mod, num_words, num_limbs);
+    sgcd_from_vli(g, input, num_words, num_limbs);
+    for (i = 0; i < num_limbs; ++i) {
+        d[i] = 0;
+        e[i] = 0;
+    }
+    e[0] = 1;
+
+    /* Newton iteration; each step doubles the number of correct bits (starting from 3). */
+    mod_inv = (sgcd_ulimb_t)m[0];
+    for (i = 0; i < 5; ++i) {
+        mod_inv *= 2 - (sgcd_ulimb_t)m[0] * mod_inv;
+    }
+
+    for (i = 0; i < num_steps; i += SGCD_LIMB_BITS) {
+        delta = sgcd_divsteps(delta, (sgcd_ulimb_t)f[0], (sgcd_ulimb_t)g[0], &t);
+        sgcd_update_de(d, e, &t, m, mod_inv, num_limbs);
+        sgcd_update_fg(f, g, &t, num_limbs);
+    }
+
+    /* Now g = 0 and f = +/-1, and d = 1 / (f * input). */
+    sgcd_normalize(d, f[num_limbs - 1], m, num_limbs);
+    sgcd_to_vli(result, d, num_words);
+}
+
+#else /* !(uECC_SAFEGCD_INVERSE && ...) */
+#define SAFEGCD_INVERSE 0
+
 #define EVEN(vli) (!(vli[0] & 1))
 static void vli_modInv_update(uECC_word_t *uv,
                               const uECC_word_t *mod,
@@ -738,9 +1393,52 @@ uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
     uECC_vli_set(result, u, num_words);
 }
 
+#endif /* !(uECC_SAFEGCD_INVERSE && ...) */
+
+/* Returns the Jacobi symbol (a / p): 1 if a is a nonzero square mod p, -1 if it is not a
+   square, and 0 if a is 0. a must be < p. Not constant time. */
+static int vli_jacobi(const uECC_word_t *a, uECC_Curve curve) {
+    uECC_word_t u[uECC_MAX_WORDS];
+    uECC_word_t w[uECC_MAX_WORDS];
+    uECC_word_t *n = w;
+    uECC_word_t *m = u;
+    uECC_word_t *tmp;
+    wordcount_t num_words = curve->num_words;
+    int result = 1;
+
+    uECC_vli_set(m, a, num_words);
+    uECC_vli_set(n, curve->p, num_words);
+    /* Binary algorithm: (m / n) with n odd, using (2 / n) = -1 iff n = 3 or 5 (mod 8) and
+       quadratic reciprocity for odd m and n. */
+    while (!uECC_vli_isZero(m, num_words)) {
+        while (!(m[0] & 1)) {
+            uECC_vli_rshift1(m, num_words);
+            if ((n[0] & 7) == 3 || (n[0] & 7) == 5) {
+                result = -result;
+            }
+        }
+        if (uECC_vli_cmp_unsafe(m, n, num_words) < 0) {
+            tmp = m;
+            m = n;
+            n = tmp;
+            if ((m[0] & 3) == 3 && (n[0] & 3) == 3) {
+                result = -result;
+            }
+        }
+        uECC_vli_sub(m, m, n, num_words);
+    }
+
+    /* n is now gcd(a, p), which is p if a is 0. */
+    uECC_vli_clear(u, num_words);
+    u[0] = 1;
+    return uECC_vli_equal(n, u, num_words) ? result : 0;
+}
+
 /* ------ Point operations ------ */
 
 #include "curve-specific.inc"
+#include "field_avx2.inc"
+#include "field_ifma.inc"
 
 /* Returns 1 if 'point' is the point at infinity, 0 otherwise. */
 #define EccPoint_isZero(point, curve) uECC_vli_isZero((point), (curve)->num_words * 2)
@@ -838,21 +1536,21 @@ static void XYcZ_addC(uECC_word_t * X1,
     uECC_vli_modSquare_fast(t5, sub, curve);          /* t5 = (x2 - x1)^2 = A */
     uECC_vli_modMult_fast(X1, X1, t5, curve);         /* t1 = x1*A = B */
     uECC_vli_modMult_fast(X2, X2, t5, curve);         /* t3 = x2*A = C */
-    uECC_vli_modAdd(t5, Y2, Y1, curve->p, num_words); /* t5 = y2 + y1 */
+    vli_modAdd_lazy(t5, Y2, Y1, curve);               /* t5 = y2 + y1 (partial) */
     uECC_vli_modSub(Y2, Y2, Y1, curve->p, num_words); /* t4 = y2 - y1 */
 
     uECC_vli_modSub(t6, X2, X1, curve->p, num_words); /* t6 = C - B */
     uECC_vli_modMult_fast(Y1, Y1, t6, curve);         /* t2 = y1 * (C - B) = E */
-    uECC_vli_modAdd(t6, X1, X2, curve->p, num_words); /* t6 = B + C */
+    vli_modAdd_lazy(t6, X1, X2, curve);               /* t6 = B + C (partial) */
     uECC_vli_modSquare_fast(X2, Y2, curve);           /* t3 = (y2 - y1)^2 = D */
-    uECC_vli_modSub(X2, X2, t6, curve->p, num_words); /* t3 = D - (B + C) = x3 */
+    vli_modSub_lazy(X2, X2, t6, curve);               /* t3 = D - (B + C) = x3 */
 
     uECC_vli_modSub(t7, X1, X2, curve->p, num_words); /* t7 = B - x3 */
     uECC_vli_modMult_fast(Y2, Y2, t7, curve);         /* t4 = (y2 - y1)*(B - x3) */
     uECC_vli_modSub(Y2, Y2, Y1, curve->p, num_words); /* t4 = (y2 - y1)*(B - x3) - E = y3 */
 
     uECC_vli_modSquare_fast(t7, t5, curve);           /* t7 = (y2 + y1)^2 = F */
-    uECC_vli_modSub(t7, t7, t6, curve->p, num_words); /* t7 = F - (B + C) = x3' */
+    vli_modSub_lazy(t7, t7, t6, curve);               /* t7 = F - (B + C) = x3' */
     uECC_vli_modSub(t6, t7, X1, curve->p, num_words); /* t6 = x3' - B */
     uECC_vli_modMult_fast(t6, t6, t5, curve);         /* t6 = (y2+y1)*(x3' - B) */
     uECC_vli_modSub(Y1, t6, Y1, curve->p, num_words); /* t2 = (y2+y1)*(x3' - B) - E = y3' */
@@ -860,6 +1558,32 @@ static void XYcZ_addC(uECC_word_t * X1,
     uECC_vli_set(X1, t7, num_words);                  /* move x3' to output */
 }
 
+/* Runs the ladder steps for bits num_bits - 2 to 0 of scalar, starting from
+   R0 = (Rx[0], Ry[0]) = P and R1 = (Rx[1], Ry[1]) = 2P with a common Z. The last step stops
+   after XYcZ_addC(), so that the caller can compute the final 1/Z. Returns the inverse of the
+   last scalar bit. */
+static uECC_word_t XYcZ_ladder(uECC_word_t (*Rx)[uECC_MAX_WORDS],
+                               uECC_word_t (*Ry)[uECC_MAX_WORDS],
+                               const uECC_word_t * scalar,
+                               bitcount_t num_bits,
+                               uECC_Curve curve) {
+    uECC_word_t sub[uECC_MAX_WORDS];
+    bitcount_t i;
+    uECC_word_t nb;
+
+    uECC_vli_modSub(sub, Rx[0], Rx[1], curve->p, curve->num_words);
+
+    for (i = num_bits - 2; i > 0; --i) {
+        nb = !uECC_vli_testBit(scalar, i);
+        XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], sub, curve);
+        XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], sub, curve);
+    }
+
+    nb = !uECC_vli_testBit(scalar, 0);
+    XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], sub, curve);
+    return nb;
+}
+
 /* result may overlap point. */
 static void EccPoint_mult(uECC_word_t * result,
                           const uECC_word_t * point,
@@ -872,7 +1596,6 @@ static void EccPoint_mult(uECC_word_t * result,
     uECC_word_t Ry[2][uECC_MAX_WORDS];
     uECC_word_t z[uECC_MAX_WORDS];
     uECC_word_t sub[uECC_MAX_WORDS];
-    bitcount_t i;
     uECC_word_t nb;
     wordcount_t num_words = curve->num_words;
 
@@ -880,22 +1603,13 @@ static void EccPoint_mult(uECC_word_t * result,
     uECC_vli_set(Ry[1], point + num_words, num_words);
 
     XYcZ_initial_double(Rx[1], Ry[1], Rx[0], Ry[0], initial_Z, curve);
-    uECC_vli_modSub(sub, Rx[0], Rx[1], curve->p, num_words);
-
-    for (i = num_bits - 2; i > 0; --i) {
-        nb = !uECC_vli_testBit(scalar, i);
-        XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], sub, curve);
-        XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], sub, curve);
-    }
-
-    nb = !uECC_vli_testBit(scalar, 0);
-    XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb], sub, curve);
+    nb = XYcZ_ladder(Rx, Ry, scalar, num_bits, curve);
 
     /* Find final 1/Z value. */
     uECC_vli_modSub(z, Rx[1], Rx[0], curve->p, num_words); /* X1 - X0 */
     uECC_vli_modMult_fast(z, z, Ry[1 - nb], curve);        /* Yb * (X1 - X0) */
     uECC_vli_modMult_fast(z, z, point, curve);             /* xP * Yb * (X1 - X0) */
-    uECC_vli_modInv(z, z, curve->p, num_words);            /* 1 / (xP * Yb * (X1 - X0)) */
+    curve->mod_inv(z, z, curve);                           /* 1 / (xP * Yb * (X1 - X0)) */
     uECC_vli_modMult_fast(z, z, point + num_words, curve); /* yP / (xP * Yb * (X1 - X0)) */
     uECC_vli_modMult_fast(z, z, Rx[1 - nb], curve);        /* Xb * yP / (xP * Yb * (X1 - X0)) */
     /* End 1/Z calculation */
@@ -907,29 +1621,1200 @@ static void EccPoint_mult(uECC_word_t * result,
     uECC_vli_set(result + num_words, Ry[0], num_words);
 }
 
-static uECC_word_t regularize_k(const uECC_word_t * const k,
-                                uECC_word_t *k0,
-                                uECC_word_t *k1,
-                                uECC_Curve curve) {
-    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-    bitcount_t num_n_bits = curve->num_n_bits;
-    uECC_word_t carry = uECC_vli_add(k0, k, curve->n, num_n_words) ||
-        (num_n_bits < ((bitcount_t)num_n_words * uECC_WORD_SIZE * 8) &&
-         uECC_vli_testBit(k0, num_n_bits));
-    uECC_vli_add(k1, k0, curve->n, num_n_words);
-    return carry;
-}
+/* Computes result = x(scalar * P), where P has x coordinate x and v = x^3 + ax + b = y^2; y itself
+   is not needed. The ladder runs on the curve Y^2 = X^3 + (a v^2) X + (b v^3), which holds
+   the point (x v, v^2) and maps to the original curve with x = X / v. The co-Z formulas do not
+   depend on a or b, so only the initial doubling and the final 1/Z change, and the division
+   by v is folded into the final inversion. num_bits and initial_Z are as for EccPoint_mult(). */
+static void EccPoint_mult_x(uECC_word_t * result,
+                            const uECC_word_t * x,
+                            const uECC_word_t * v,
+                            const uECC_word_t * scalar,
+                            const uECC_word_t * initial_Z,
+                            bitcount_t num_bits,
+                            uECC_Curve curve) {
+    /* R0 and R1 */
+    uECC_word_t Rx[2][uECC_MAX_WORDS];
+    uECC_word_t Ry[2][uECC_MAX_WORDS];
+    uECC_word_t m[uECC_MAX_WORDS];
+    uECC_word_t t1[uECC_MAX_WORDS];
+    uECC_word_t t2[uECC_MAX_WORDS];
+    uECC_word_t nb;
+    wordcount_t num_words = curve->num_words;
 
-/* Generates a random integer in the range 0 < random < top.
-   Both random and top have num_words words. */
-uECC_VLI_API int uECC_generate_random_int(uECC_word_t *random,
-                                          const uECC_word_t *top,
-                                          wordcount_t num_words) {
-    uECC_word_t mask = (uECC_word_t)-1;
-    uECC_word_t tries;
-    bitcount_t num_bits = uECC_vli_numBits(top, num_words);
+    uECC_vli_clear(t1, num_words);
+    t1[0] = 1;
+    curve->x_side(m, t1, curve);                            /* m = 1 + a + b */
+    uECC_vli_modSub(m, m, t1, curve->p, num_words);
+    uECC_vli_modSub(m, m, curve->b, curve->p, num_words);   /* m = a */
+    uECC_vli_modSquare_fast(t1, x, curve);                  /* t1 = x^2 */
+    uECC_vli_modAdd(m, m, t1, curve->p, num_words);
+    uECC_vli_modAdd(m, m, t1, curve->p, num_words);
+    uECC_vli_modAdd(m, m, t1, curve->p, num_words);         /* m = 3x^2 + a */
+
+    /* Double (X, Y) = (x v, v^2), as in XYcZ_initial_double(): R1 = 2P and R0 = P, with Z = 2Y.
+       The slope numerator is 3X^2 + (a v^2) = v^2 (3x^2 + a). */
+    uECC_vli_modSquare_fast(Ry[1], v, curve);               /* Y = v^2 */
+    uECC_vli_modMult_fast(m, m, Ry[1], curve);              /* M = v^2 (3x^2 + a) */
+    uECC_vli_modMult_fast(Rx[0], x, v, curve);              /* X = x v */
+    uECC_vli_modAdd(t1, Ry[1], Ry[1], curve->p, num_words); /* t1 = 2Y */
+    uECC_vli_modSquare_fast(t2, t1, curve);                 /* t2 = 4Y^2 */
+    uECC_vli_modMult_fast(Rx[0], Rx[0], t2, curve);         /* x0 = 4XY^2 = S */
+    uECC_vli_modMult_fast(t1, t1, t2, curve);               /* t1 = 8Y^3 */
+    uECC_vli_modMult_fast(Ry[0], Ry[1], t1, curve);         /* y0 = 8Y^4 */
+    uECC_vli_modSquare_fast(Rx[1], m, curve);               /* x1 = M^2 */
+    uECC_vli_modSub(Rx[1], Rx[1], Rx[0], curve->p, num_words);
+    uECC_vli_modSub(Rx[1], Rx[1], Rx[0], curve->p, num_words); /* x1 = M^2 - 2S */
+    uECC_vli_modSub(t1, Rx[0], Rx[1], curve->p, num_words);    /* t1 = S - x1 */
+    uECC_vli_modMult_fast(Ry[1], m, t1, curve);                /* y1 = M (S - x1) */
+    uECC_vli_modSub(Ry[1], Ry[1], Ry[0], curve->p, num_words); /* y1 = M (S - x1) - 8Y^4 */
+    if (initial_Z) {
+        apply_z(Rx[0], Ry[0], initial_Z, curve);
+        apply_z(Rx[1], Ry[1], initial_Z, curve);
+    }
 
-    if (!g_rng_function) {
+    nb = XYcZ_ladder(Rx, Ry, scalar, num_bits, curve);
+
+    /* Find final 1/Z value as in EccPoint_mult(), with (xP, yP) = (x v, v^2). Then
+       result = X0 * (1/Z)^2 / v = X0 * (Xb / (x * Yb * (X1 - X0)))^2 * v. */
+    uECC_vli_modSub(t1, Rx[1], Rx[0], curve->p, num_words); /* X1 - X0 */
+    uECC_vli_modMult_fast(t1, t1, Ry[1 - nb], curve);       /* Yb * (X1 - X0) */
+    uECC_vli_modMult_fast(t1, t1, x, curve);                /* x * Yb * (X1 - X0) */
+    curve->mod_inv(t1, t1, curve);                          /* 1 / (x * Yb * (X1 - X0)) */
+    uECC_vli_modMult_fast(t1, t1, Rx[1 - nb], curve);       /* Xb / (x * Yb * (X1 - X0)) */
+
+    XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb], m, curve);
+    uECC_vli_modSquare_fast(t1, t1, curve);
+    uECC_vli_modMult_fast(t1, t1, v, curve);
+    uECC_vli_modMult_fast(result, Rx[0], t1, curve);
+}
+
+/* (x1, y1, z1) => (x1, y1, z1) + (x2, y2), where (x2, y2) is in affine coordinates.
+   Returns nonzero if x1 and x2 represent the same x coordinate, in which case the result
+   is not the correct sum. */
+static uECC_word_t add_jacobian_affine(uECC_word_t * X1,
+                                       uECC_word_t * Y1,
+                                       uECC_word_t * Z1,
+                                       const uECC_word_t * const x2,
+                                       const uECC_word_t * const y2,
+                                       uECC_Curve curve) {
+    uECC_word_t t1[uECC_MAX_WORDS];
+    uECC_word_t t2[uECC_MAX_WORDS];
+    uECC_word_t t3[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    uECC_word_t degenerate;
+
+    uECC_vli_modSquare_fast(t1, Z1, curve);            /* t1 = z1^2 */
+    uECC_vli_modMult_fast(t2, t1, Z1, curve);          /* t2 = z1^3 */
+    uECC_vli_modMult_fast(t1, t1, x2, curve);          /* t1 = x2*z1^2 = U2 */
+    uECC_vli_modMult_fast(t2, t2, y2, curve);          /* t2 = y2*z1^3 = S2 */
+    uECC_vli_modSub(t1, t1, X1, curve->p, num_words);  /* t1 = U2 - x1 = H */
+    uECC_vli_modSub(t2, t2, Y1, curve->p, num_words);  /* t2 = S2 - y1 = R */
+    degenerate = uECC_vli_isZero(t1, num_words);
+
+    uECC_vli_modMult_fast(Z1, Z1, t1, curve);          /* z3 = z1*H */
+    uECC_vli_modSquare_fast(t3, t1, curve);            /* t3 = H^2 */
+    uECC_vli_modMult_fast(t1, t1, t3, curve);          /* t1 = H^3 */
+    uECC_vli_modMult_fast(t3, t3, X1, curve);          /* t3 = x1*H^2 = V */
+    uECC_vli_modSquare_fast(X1, t2, curve);            /* x3 = R^2 */
+    uECC_vli_modSub(X1, X1, t1, curve->p, num_words);  /* x3 = R^2 - H^3 */
+    uECC_vli_modSub(X1, X1, t3, curve->p, num_words);  /* x3 = R^2 - H^3 - V */
+    uECC_vli_modSub(X1, X1, t3, curve->p, num_words);  /* x3 = R^2 - H^3 - 2V */
+    uECC_vli_modSub(t3, t3, X1, curve->p, num_words);  /* t3 = V - x3 */
+    uECC_vli_modMult_fast(t3, t3, t2, curve);          /* t3 = R*(V - x3) */
+    uECC_vli_modMult_fast(t1, t1, Y1, curve);          /* t1 = y1*H^3 */
+    uECC_vli_modSub(Y1, t3, t1, curve->p, num_words);  /* y3 = R*(V - x3) - y1*H^3 */
+
+    return degenerate;
+}
+
+/* Loads entry 'index' of a table of size affine points into (x, y), negated if 'negate' is 1.
+   Every table entry is read, so the memory access pattern does not depend on index. */
+static void table_lookup(uECC_word_t *x,
+                         uECC_word_t *y,
+                         const uECC_word_t *table,
+                         wordcount_t size,
+                         uECC_word_t index,
+                         uECC_word_t negate,
+                         uECC_Curve curve) {
+    uECC_word_t neg_y[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    uECC_word_t mask;
+    wordcount_t i;
+    wordcount_t t;
+
+    uECC_vli_clear(x, num_words);
+    uECC_vli_clear(y, num_words);
+    for (t = 0; t < size; ++t, table += num_words * 2) {
+        mask = -(uECC_word_t)((uECC_word_t)t == index);
+        for (i = 0; i < num_words; ++i) {
+            x[i] |= table[i] & mask;
+            y[i] |= table[num_words + i] & mask;
+        }
+    }
+
+    uECC_vli_sub(neg_y, curve->p, y, num_words);
+    mask = -negate;
+    for (i = 0; i < num_words; ++i) {
+        y[i] ^= (y[i] ^ neg_y[i]) & mask;
+    }
+}
+
+#if uECC_G_COMB_TEETH
+
+#define G_COMB_SIZE (1 << (uECC_G_COMB_TEETH - 1))
+
+/* Loads the comb entry for the given column into (x, y), reading every table entry. */
+static void comb_lookup(uECC_word_t *x,
+                        uECC_word_t *y,
+                        const uECC_word_t *digits,
+                        bitcount_t column,
+                        bitcount_t spacing,
+                        uECC_Curve curve) {
+    uECC_word_t top = !!uECC_vli_testBit(digits, column + (uECC_G_COMB_TEETH - 1) * spacing);
+    uECC_word_t index = 0;
+    bitcount_t t;
+
+    /* The table only holds columns whose top digit is +1; the others are negated. */
+    for (t = 0; t < uECC_G_COMB_TEETH - 1; ++t) {
+        index |= ((!!uECC_vli_testBit(digits, column + t * spacing)) ^ top ^ 1) << t;
+    }
+    table_lookup(x, y, curve->G_comb, G_COMB_SIZE, index, top ^ 1, curve);
+}
+
+/* Computes result = scalar * G for 0 < scalar < n, using a signed-digit comb.
+   The scalar is made odd by adding n if needed, and then written as
+   sum((2 * u_i - 1) * 2^i) for i < m, where u = (scalar - 1) / 2 + 2^(m - 1) and
+   m = uECC_G_COMB_TEETH * spacing. Column j of the comb combines the digits
+   j, j + spacing, j + 2 * spacing, ...; its value is looked up in curve->G_comb.
+
+   If result_Z is not 0, the result is left in Jacobian coordinates, with its Z value in
+   result_Z (which may be the same as initial_Z).
+
+   Returns 0 if an exceptional case of the addition formula was hit, which only happens
+   for specially constructed scalars; the caller should then use EccPoint_mult(). */
+static uECC_word_t EccPoint_mult_G(uECC_word_t * result,
+                                   const uECC_word_t * scalar,
+                                   const uECC_word_t * initial_Z,
+                                   uECC_word_t * result_Z,
+                                   uECC_Curve curve) {
+    uECC_word_t u[uECC_MAX_WORDS + 1];
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t *rx = result;
+    uECC_word_t *ry = result + curve->num_words;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t spacing = (curve->num_n_bits + uECC_G_COMB_TEETH) / uECC_G_COMB_TEETH;
+    bitcount_t top_bit = uECC_G_COMB_TEETH * spacing - 1;
+    uECC_word_t mask = (scalar[0] & 1) - 1;
+    uECC_word_t degenerate = 0;
+    bitcount_t i;
+
+    for (i = 0; i < num_n_words; ++i) {
+        u[i] = curve->n[i] & mask;
+    }
+    u[num_n_words] = uECC_vli_add(u, scalar, u, num_n_words);
+    uECC_vli_rshift1(u, num_n_words + 1);
+    u[top_bit >> uECC_WORD_BITS_SHIFT] |= (uECC_word_t)1 << (top_bit & uECC_WORD_BITS_MASK);
+
+    comb_lookup(rx, ry, u, spacing - 1, spacing, curve);
+    if (initial_Z) {
+        uECC_vli_set(z, initial_Z, num_words);
+        apply_z(rx, ry, z, curve);
+    } else {
+        uECC_vli_clear(z, num_words);
+        z[0] = 1;
+    }
+
+    for (i = spacing - 2; i >= 0; --i) {
+        curve->double_jacobian(rx, ry, z, curve);
+        comb_lookup(tx, ty, u, i, spacing, curve);
+        degenerate |= add_jacobian_affine(rx, ry, z, tx, ty, curve);
+    }
+
+    if (result_Z) {
+        uECC_vli_set(result_Z, z, num_words);
+        return !degenerate;
+    }
+    curve->mod_inv(z, z, curve);
+    apply_z(rx, ry, z, curve);
+    return !degenerate;
+}
+
+/* Returns 1 if scalar is 1, n - 2 or n - 1, for 0 < scalar < n. The co-Z ladder cannot compute
+   these multiples of G, so EccPoint_compute_public_key() leaves them to it rather than to the
+   comb, and its result does not depend on uECC_G_COMB_TEETH. Runs in constant time. */
+static uECC_word_t comb_skips_scalar(const uECC_word_t * scalar, uECC_Curve curve) {
+    uECC_word_t diff[uECC_MAX_WORDS];
+    uECC_word_t scalar_high = 0;
+    uECC_word_t diff_high = 0;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    wordcount_t i;
+
+    uECC_vli_sub(diff, curve->n, scalar, num_n_words);
+    for (i = 1; i < num_n_words; ++i) {
+        scalar_high |= scalar[i];
+        diff_high |= diff[i];
+    }
+    return (!scalar_high & (scalar[0] == 1)) |
+           (!diff_high & ((uECC_word_t)(diff[0] - 1) < 2));
+}
+
+#endif /* uECC_G_COMB_TEETH */
+
+/* Window widths for the non-adjacent forms in uECC_verify(). The narrower window halves the
+   tables on the stack for small targets. */
+#if (uECC_WORD_SIZE == 1) || !uECC_FAST_DEFAULTS
+    #define Q_WNAF_WINDOW 4
+#else
+    #define Q_WNAF_WINDOW 5
+#endif
+#if uECC_G_WNAF_WINDOW
+    #define G_WNAF_WINDOW uECC_G_WNAF_WINDOW
+#else
+    #define G_WNAF_WINDOW Q_WNAF_WINDOW
+#endif
+#define WNAF_TABLE_SIZE(window) (1 << ((window) - 2))
+
+/* Largest table of odd multiples built by wnaf_table(). */
+#if uECC_PREPARED_WINDOW > Q_WNAF_WINDOW
+    #define WNAF_MAX_WINDOW uECC_PREPARED_WINDOW
+#else
+    #define WNAF_MAX_WINDOW Q_WNAF_WINDOW
+#endif
+#if uECC_MULT_WINDOW > WNAF_MAX_WINDOW - 1
+    #define MAX_TABLE_SIZE (1 << (uECC_MULT_WINDOW - 1))
+#else
+    #define MAX_TABLE_SIZE WNAF_TABLE_SIZE(WNAF_MAX_WINDOW)
+#endif
+
+/* Computes the width-w non-adjacent form of k, which has num_bits bits: every digit naf[i]
+   is either 0 or odd with |naf[i]| < 2^(w - 1), nonzero digits are at least w positions
+   apart, and k = sum(naf[i] * 2^i). naf must have room for num_bits + 1 digits. */
+static void vli_wnaf(int8_t *naf, const uECC_word_t *k, bitcount_t num_bits, bitcount_t w) {
+    bitcount_t bit = 0;
+    bitcount_t i;
+    int carry = 0;
+    int digit;
+
+    for (i = 0; i <= num_bits; ++i) {
+        naf[i] = 0;
+    }
+
+    while (bit <= num_bits) {
+        if ((bit < num_bits && uECC_vli_testBit(k, bit)) == carry) {
+            ++bit;
+            continue;
+        }
+
+        digit = carry;
+        for (i = 0; i < w && bit + i < num_bits; ++i) {
+            digit += (!!uECC_vli_testBit(k, bit + i)) << i;
+        }
+        carry = (digit >> (w - 1)) & 1;
+        naf[bit] = (int8_t)(digit - (carry << w));
+        bit += w;
+    }
+}
+
+/* Computes table[i] = (2i + 1) * point, for i < size. The multiples are built with co-Z
+   additions of 2 * point and left in Jacobian coordinates: entry i has the Z coordinate
+   z * ratios[0] * ... * ratios[i - 1], where ratios holds size - 1 values, uECC_MAX_WORDS apart.
+   wnaf_table_normalize() then brings them all to affine coordinates given 1 / z. */
+static void wnaf_table_build(uECC_word_t *table,
+                             const uECC_word_t *point,
+                             wordcount_t size,
+                             uECC_word_t *ratios,
+                             uECC_word_t *z,
+                             uECC_Curve curve) {
+    uECC_word_t p2[uECC_MAX_WORDS * 2];
+    uECC_word_t sub[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    uECC_word_t *entry;
+    wordcount_t i;
+
+    uECC_vli_set(p2, point, num_words * 2);
+    uECC_vli_set(table, point, num_words * 2);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+    curve->double_jacobian(p2, p2 + num_words, z, curve);
+    apply_z(table, table + num_words, z, curve);
+
+    for (i = 1; i < size; ++i) {
+        entry = table + i * num_words * 2;
+        uECC_vli_set(entry, entry - num_words * 2, num_words * 2);
+        uECC_vli_modSub(ratios + (i - 1) * uECC_MAX_WORDS, entry, p2, curve->p, num_words);
+        XYcZ_add(p2, p2 + num_words, entry, entry + num_words, sub, curve);
+        uECC_vli_modMult_fast(z, z, ratios + (i - 1) * uECC_MAX_WORDS, curve);
+    }
+}
+
+/* Brings a table from wnaf_table_build() to affine coordinates. z_inv is 1 / z on input, and
+   is overwritten. */
+static void wnaf_table_normalize(uECC_word_t *table,
+                                 wordcount_t size,
+                                 const uECC_word_t *ratios,
+                                 uECC_word_t *z_inv,
+                                 uECC_Curve curve) {
+    wordcount_t num_words = curve->num_words;
+    uECC_word_t *entry;
+    wordcount_t i;
+
+    for (i = size - 1; i >= 0; --i) {
+        entry = table + i * num_words * 2;
+        apply_z(entry, entry + num_words, z_inv, curve);
+        if (i > 0) {
+            uECC_vli_modMult_fast(z_inv, z_inv, ratios + (i - 1) * uECC_MAX_WORDS, curve);
+        }
+    }
+}
+
+/* Computes table[i] = (2i + 1) * point in affine coordinates, for i < size, with a single
+   inversion. */
+static void wnaf_table(uECC_word_t *table,
+                       const uECC_word_t *point,
+                       wordcount_t size,
+                       uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t ratios[MAX_TABLE_SIZE - 1][uECC_MAX_WORDS];
+
+    wnaf_table_build(table, point, size, ratios[0], z, curve);
+    curve->mod_inv(z, z, curve);
+    wnaf_table_normalize(table, size, ratios[0], z, curve);
+}
+
+/* (X1, Y1, Z1) => (X1, Y1, Z1) + (X2, Y2, Z2), where Z2 is 0 if (X2, Y2) is in affine
+   coordinates. *is_infinity tells whether (X1, Y1, Z1) is the point at infinity, and is
+   updated for the result; (X2, Y2, Z2) must not be the point at infinity. Not constant time. */
+static void add_points_vartime(uECC_word_t * X1,
+                               uECC_word_t * Y1,
+                               uECC_word_t * Z1,
+                               uECC_word_t *is_infinity,
+                               const uECC_word_t * X2,
+                               const uECC_word_t * Y2,
+                               const uECC_word_t * Z2,
+                               uECC_Curve curve) {
+    uECC_word_t old_y[uECC_MAX_WORDS];
+    uECC_word_t old_z[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    if (!*is_infinity) {
+        if (Z2) {
+            /* Work in coordinates scaled by Z2, where (X2, Y2) is affine. The addition formula
+               does not depend on the a coefficient that the scaling changes. */
+            uECC_vli_modSquare_fast(t, Z2, curve);
+            uECC_vli_modMult_fast(X1, X1, t, curve);
+            uECC_vli_modMult_fast(t, t, Z2, curve);
+            uECC_vli_modMult_fast(Y1, Y1, t, curve);
+        }
+        uECC_vli_set(old_y, Y1, num_words);
+        uECC_vli_set(old_z, Z1, num_words);
+        if (!add_jacobian_affine(X1, Y1, Z1, X2, Y2, curve)) {
+            if (Z2) {
+                uECC_vli_modMult_fast(Z1, Z1, Z2, curve);
+            }
+            return;
+        }
+
+        /* Same x coordinate: the sum is either 2 * (X2, Y2) or the point at infinity. */
+        uECC_vli_modSquare_fast(t, old_z, curve);
+        uECC_vli_modMult_fast(t, t, old_z, curve);
+        uECC_vli_modMult_fast(t, t, Y2, curve);   /* Y2 * z1^3 */
+        if (!uECC_vli_equal(t, old_y, num_words)) {
+            *is_infinity = 1;
+            return;
+        }
+    }
+
+    uECC_vli_set(X1, X2, num_words);
+    uECC_vli_set(Y1, Y2, num_words);
+    if (Z2) {
+        uECC_vli_set(Z1, Z2, num_words);
+    } else {
+        uECC_vli_clear(Z1, num_words);
+        Z1[0] = 1;
+    }
+    if (!*is_infinity) {
+        curve->double_jacobian(X1, Y1, Z1, curve);
+    }
+    *is_infinity = 0;
+}
+
+/* (x1, y1, z1) => (x1, y1, z1) + digit * P, where table holds the odd multiples of P in
+   affine coordinates and digit is odd. *is_infinity tells whether (x1, y1, z1) is the point
+   at infinity, and is updated for the result. Not constant time. */
+static void add_wnaf_entry(uECC_word_t * X1,
+                           uECC_word_t * Y1,
+                           uECC_word_t * Z1,
+                           uECC_word_t *is_infinity,
+                           const uECC_word_t *table,
+                           int8_t digit,
+                           uECC_Curve curve) {
+    uECC_word_t ty[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    const uECC_word_t *entry = table + ((digit < 0 ? -digit : digit) >> 1) * num_words * 2;
+
+    uECC_vli_set(ty, entry + num_words, num_words);
+    if (digit < 0) {
+        uECC_vli_sub(ty, curve->p, ty, num_words);
+    }
+    add_points_vartime(X1, Y1, Z1, is_infinity, entry, ty, 0, curve);
+}
+
+/* uECC_verify_batch() recovers R from r with curve->mod_sqrt(), so it needs compressed point
+   support to combine signatures. */
+#if uECC_VERIFY_BATCH_SIZE && uECC_SUPPORT_COMPRESSED_POINT
+    #define VERIFY_BATCH 1
+#else
+    #define VERIFY_BATCH 0
+#endif
+
+/* Montgomery's trick is shared by the VLI multi-point functions and every batch or pool API. */
+#if uECC_ENABLE_VLI_API || VERIFY_BATCH || uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE || \
+    uECC_MAKE_KEY_BATCH_SIZE || uECC_KEY_POOL_SIZE || uECC_SHARED_SECRET_BATCH_SIZE
+    #define BATCH_MOD_INV 1
+#else
+    #define BATCH_MOD_INV 0
+#endif
+
+#if BATCH_MOD_INV
+
+/* result = left * right, mod n if mod_n is 1 and mod p otherwise. */
+static void batch_mod_mult(uECC_word_t *result,
+                           const uECC_word_t *left,
+                           const uECC_word_t *right,
+                           uECC_word_t mod_n,
+                           uECC_Curve curve) {
+    if (mod_n) {
+        vli_modMult_n(result, left, right, curve);
+    } else {
+        uECC_vli_modMult_fast(result, left, right, curve);
+    }
+}
+
+/* Replaces each of the count values (uECC_MAX_WORDS apart) with its inverse mod n if mod_n is 1
+   and mod p otherwise, using a single inversion (Montgomery's trick). products must have room
+   for count values. None of the values may be 0. */
+static void batch_mod_inv(uECC_word_t *values,
+                          unsigned count,
+                          uECC_word_t *products,
+                          uECC_word_t mod_n,
+                          uECC_Curve curve) {
+    uECC_word_t inv[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    wordcount_t num_words = (mod_n ? BITS_TO_WORDS(curve->num_n_bits) : curve->num_words);
+    unsigned i;
+
+    /* products[i] = values[0] * ... * values[i] */
+    uECC_vli_set(products, values, num_words);
+    for (i = 1; i < count; ++i) {
+        batch_mod_mult(products + i * uECC_MAX_WORDS, products + (i - 1) * uECC_MAX_WORDS,
+                       values + i * uECC_MAX_WORDS, mod_n, curve);
+    }
+    if (mod_n) {
+        uECC_vli_modInv(inv, products + (count - 1) * uECC_MAX_WORDS, curve->n, num_words);
+    } else {
+        curve->mod_inv(inv, products + (count - 1) * uECC_MAX_WORDS, curve);
+    }
+    for (i = count - 1; i > 0; --i) {
+        batch_mod_mult(t, inv, products + (i - 1) * uECC_MAX_WORDS, mod_n, curve);
+        batch_mod_mult(inv, inv, values + i * uECC_MAX_WORDS, mod_n, curve);
+        uECC_vli_set(values + i * uECC_MAX_WORDS, t, num_words);
+    }
+    uECC_vli_set(values, inv, num_words);
+}
+
+#endif /* BATCH_MOD_INV */
+
+#if uECC_ENABLE_VLI_API || VERIFY_BATCH
+
+/* Number of points whose tables are kept at the same time by the interleaved (Straus) method in
+   EccPoint_multi_mult(), and largest window width of its bucket (Pippenger) method. */
+#if (uECC_WORD_SIZE == 1)
+    #define STRAUS_POINTS 2
+    #define PIPPENGER_MAX_WINDOW 4
+#else
+    #define STRAUS_POINTS 8
+    #define PIPPENGER_MAX_WINDOW 7
+#endif
+
+/* Rough costs of the operations in EccPoint_multi_mult(), relative to a mixed addition
+   (times 10): a doubling, an addition of two Jacobian points, and an inversion. */
+#define COST_DOUBLE 7
+#define COST_ADD 10
+#define COST_ADD_JACOBIAN 15
+#define COST_INVERSE 80
+
+/* (X1, Y1, Z1) => (X1, Y1, Z1) + sum(scalars[i] * points[i]) for i < count <= STRAUS_POINTS,
+   interleaving the width-Q_WNAF_WINDOW non-adjacent forms of the scalars as in uECC_verify().
+   The tables of odd multiples of all the points are brought to affine coordinates with a
+   single inversion. Not constant time. */
+static void multi_mult_straus(uECC_word_t * X1,
+                              uECC_word_t * Y1,
+                              uECC_word_t * Z1,
+                              uECC_word_t *is_infinity,
+                              const uECC_word_t *points,
+                              const uECC_word_t *scalars,
+                              unsigned count,
+                              uECC_Curve curve) {
+    uECC_word_t tables[STRAUS_POINTS][WNAF_TABLE_SIZE(Q_WNAF_WINDOW) * uECC_MAX_WORDS * 2];
+    uECC_word_t ratios[STRAUS_POINTS][WNAF_TABLE_SIZE(Q_WNAF_WINDOW) - 1][uECC_MAX_WORDS];
+    uECC_word_t z[STRAUS_POINTS][uECC_MAX_WORDS];
+    uECC_word_t products[STRAUS_POINTS][uECC_MAX_WORDS];
+    int8_t naf[STRAUS_POINTS][uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_MAX_WORDS];
+    uECC_word_t rz[uECC_MAX_WORDS];
+    uECC_word_t r_is_infinity = 1;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t num_bits = 0;
+    bitcount_t i;
+    unsigned j;
+
+    for (j = 0; j < count; ++j) {
+        i = uECC_vli_numBits(scalars + j * num_n_words, num_n_words);
+        num_bits = (i > num_bits ? i : num_bits);
+        wnaf_table_build(tables[j], points + j * num_words * 2, WNAF_TABLE_SIZE(Q_WNAF_WINDOW),
+                         ratios[j][0], z[j], curve);
+    }
+    batch_mod_inv(z[0], count, products[0], 0, curve);
+    for (j = 0; j < count; ++j) {
+        wnaf_table_normalize(tables[j], WNAF_TABLE_SIZE(Q_WNAF_WINDOW), ratios[j][0], z[j],
+                             curve);
+        vli_wnaf(naf[j], scalars + j * num_n_words, num_bits, Q_WNAF_WINDOW);
+    }
+
+    for (i = num_bits; i >= 0; --i) {
+        if (!r_is_infinity) {
+            curve->double_jacobian(rx, ry, rz, curve);
+        }
+        for (j = 0; j < count; ++j) {
+            if (naf[j][i]) {
+                add_wnaf_entry(rx, ry, rz, &r_is_infinity, tables[j], naf[j][i], curve);
+            }
+        }
+    }
+    if (!r_is_infinity) {
+        add_points_vartime(X1, Y1, Z1, is_infinity, rx, ry, rz, curve);
+    }
+}
+
+/* Returns digit 'window' of the signed radix-2^w (Booth) recoding of k, which has num_words
+   words. The digit lies in [-2^(w - 1), 2^(w - 1)] and only depends on bits window * w - 1 to
+   window * w + w - 1 of k. */
+static int booth_digit(const uECC_word_t *k,
+                       wordcount_t num_words,
+                       bitcount_t window,
+                       bitcount_t w) {
+    int bits = 0;
+    bitcount_t start = window * w - 1;
+    bitcount_t i;
+
+    for (i = (window ? 0 : 1); i <= w && start + i < num_words * uECC_WORD_BITS; ++i) {
+        bits |= (!!uECC_vli_testBit(k, start + i)) << i;
+    }
+    return ((bits >> 1) + (bits & 1)) - ((bits >> w) << w);
+}
+
+/* (X1, Y1, Z1) => (X1, Y1, Z1) + sum(scalars[i] * points[i]) for i < count, with Pippenger's
+   bucket method: for each w-bit window, every point is added (or subtracted) into the bucket
+   of its digit, and the buckets are then summed with their weights. Not constant time. */
+static void multi_mult_pippenger(uECC_word_t * X1,
+                                 uECC_word_t * Y1,
+                                 uECC_word_t * Z1,
+                                 uECC_word_t *is_infinity,
+                                 const uECC_word_t *points,
+                                 const uECC_word_t *scalars,
+                                 unsigned count,
+                                 bitcount_t w,
+                                 bitcount_t num_bits,
+                                 uECC_Curve curve) {
+    uECC_word_t buckets[1 << (PIPPENGER_MAX_WINDOW - 1)][3][uECC_MAX_WORDS];
+    uECC_word_t bucket_is_infinity[1 << (PIPPENGER_MAX_WINDOW - 1)];
+    uECC_word_t running[3][uECC_MAX_WORDS];
+    uECC_word_t sum[3][uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t running_is_infinity;
+    uECC_word_t sum_is_infinity;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t num_buckets = 1 << (w - 1);
+    bitcount_t window;
+    bitcount_t j;
+    unsigned i;
+    int digit;
+
+    for (window = num_bits / w; window >= 0; --window) {
+        for (j = 0; !*is_infinity && j < w; ++j) {
+            curve->double_jacobian(X1, Y1, Z1, curve);
+        }
+
+        for (j = 0; j < num_buckets; ++j) {
+            bucket_is_infinity[j] = 1;
+        }
+        for (i = 0; i < count; ++i) {
+            digit = booth_digit(scalars + i * num_n_words, num_n_words, window, w);
+            if (!digit) {
+                continue;
+            }
+            j = (digit < 0 ? -digit : digit) - 1;
+            uECC_vli_set(ty, points + i * num_words * 2 + num_words, num_words);
+            if (digit < 0) {
+                uECC_vli_sub(ty, curve->p, ty, num_words);
+            }
+            add_points_vartime(buckets[j][0], buckets[j][1], buckets[j][2],
+                               &bucket_is_infinity[j], points + i * num_words * 2, ty, 0,
+                               curve);
+        }
+
+        /* sum = 1 * bucket[0] + 2 * bucket[1] + ..., as a sum of running sums. */
+        running_is_infinity = 1;
+        sum_is_infinity = 1;
+        for (j = num_buckets - 1; j >= 0; --j) {
+            if (!bucket_is_infinity[j]) {
+                add_points_vartime(running[0], running[1], running[2], &running_is_infinity,
+                                   buckets[j][0], buckets[j][1], buckets[j][2], curve);
+            }
+            if (!running_is_infinity) {
+                add_points_vartime(sum[0], sum[1], sum[2], &sum_is_infinity,
+                                   running[0], running[1], running[2], curve);
+            }
+        }
+        if (!sum_is_infinity) {
+            add_points_vartime(X1, Y1, Z1, is_infinity, sum[0], sum[1], sum[2], curve);
+        }
+    }
+}
+
+/* Computes result = sum(scalars[i] * points[i]) for i < count, in affine coordinates. points
+   holds count points (2 * num_words words each), and scalars holds count scalars (num_n_words
+   words each). Uses the interleaved method for a few points and the bucket method for many,
+   whichever is estimated to be cheaper. Not constant time.
+
+   Returns 0 if the result is the point at infinity (result is then set to 0). */
+static uECC_word_t EccPoint_multi_mult(uECC_word_t *result,
+                                       const uECC_word_t *points,
+                                       const uECC_word_t *scalars,
+                                       unsigned count,
+                                       uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+    uECC_word_t is_infinity = 1;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t num_bits = 0;
+    bitcount_t best_w = 0;
+    bitcount_t w;
+    unsigned long cost;
+    unsigned long best_cost;
+    unsigned chunk;
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        w = uECC_vli_numBits(scalars + i * num_n_words, num_n_words);
+        num_bits = (w > num_bits ? w : num_bits);
+    }
+
+    /* Straus: doublings and one inversion per group of STRAUS_POINTS points, plus one addition
+       per Q_WNAF_WINDOW + 1 bits and a table for each point. */
+    best_cost = ((count + STRAUS_POINTS - 1) / STRAUS_POINTS) *
+                    ((unsigned long)num_bits * COST_DOUBLE + COST_INVERSE) +
+                count * ((unsigned long)num_bits / (Q_WNAF_WINDOW + 1) * COST_ADD +
+                         WNAF_TABLE_SIZE(Q_WNAF_WINDOW) * COST_ADD);
+    /* Pippenger: for each window, one addition per point and two per bucket. */
+    for (w = 2; w <= PIPPENGER_MAX_WINDOW; ++w) {
+        cost = (unsigned long)(num_bits / w + 1) *
+               (count * COST_ADD + (2UL << (w - 1)) * COST_ADD_JACOBIAN + w * COST_DOUBLE);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_w = w;
+        }
+    }
+
+    if (best_w) {
+        multi_mult_pippenger(result, result + num_words, z, &is_infinity, points, scalars,
+                             count, best_w, num_bits, curve);
+    } else {
+        for (i = 0; i < count; i += chunk) {
+            chunk = (count - i < STRAUS_POINTS ? count - i : STRAUS_POINTS);
+            multi_mult_straus(result, result + num_words, z, &is_infinity,
+                              points + i * num_words * 2, scalars + i * num_n_words, chunk,
+                              curve);
+        }
+    }
+
+    if (is_infinity || uECC_vli_isZero(z, num_words)) {
+        uECC_vli_clear(result, num_words * 2);
+        return 0;
+    }
+    curve->mod_inv(z, z, curve);
+    apply_z(result, result + num_words, z, curve);
+    return 1;
+}
+
+#endif /* uECC_ENABLE_VLI_API || VERIFY_BATCH */
+
+/* Loads the digit for 'window' of the regular signed-digit form of the odd value k into (x, y),
+   negated if 'negate' is 1. The digit is ((k >> (window * w)) mod 2^(w + 1)), with the lowest
+   bit set, minus 2^w; the top window (num_windows - 1) has no 2^w subtracted. Every digit is
+   then odd with absolute value less than 2^w, and table holds the odd multiples P, 3P, ...,
+   (2^w - 1)P. The lookup does not depend on the value of the digit. */
+static void regular_lookup(uECC_word_t *x,
+                           uECC_word_t *y,
+                           const uECC_word_t *table,
+                           const uECC_word_t *k,
+                           bitcount_t window,
+                           bitcount_t w,
+                           bitcount_t num_windows,
+                           uECC_word_t negate,
+                           uECC_Curve curve) {
+    uECC_word_t bits = 1;
+    uECC_word_t sign = 0;
+    bitcount_t i;
+
+    for (i = 1; i <= w; ++i) {
+        bits |= (uECC_word_t)(!!uECC_vli_testBit(k, window * w + i)) << i;
+    }
+    if (window < num_windows - 1) {
+        /* A negative digit -d has bit w clear, and its low bits are 2^w - d. */
+        sign = (bits >> w) ^ 1;
+        bits ^= -sign;
+    }
+    table_lookup(x, y, table, (wordcount_t)1 << (w - 1),
+                 (bits & (((uECC_word_t)1 << w) - 1)) >> 1, sign ^ negate, curve);
+}
+
+/* Computes result = scalar * P in constant time, for scalar < 2^num_n_bits, where table holds
+   the 2^(window - 1) odd multiples of P in affine coordinates. The scalar is made odd by adding
+   n if needed (as in EccPoint_mult_G()), and then written in the regular signed-digit form of
+   regular_lookup(), so that every window takes 'window' doublings and one addition.
+
+   If result_Z is not 0, the result is left in Jacobian coordinates, with its Z value in
+   result_Z.
+
+   Returns 0 if an exceptional case of the addition formula was hit, which only happens
+   for specially constructed inputs; result is then left untouched and the caller should use
+   EccPoint_mult(). */
+static uECC_word_t EccPoint_mult_table(uECC_word_t * result,
+                                       const uECC_word_t * table,
+                                       bitcount_t window,
+                                       const uECC_word_t * scalar,
+                                       const uECC_word_t * initial_Z,
+                                       uECC_word_t * result_Z,
+                                       uECC_Curve curve) {
+    uECC_word_t k[uECC_MAX_WORDS + 1];
+    uECC_word_t r[3][uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t num_windows = (curve->num_n_bits + window) / window;
+    uECC_word_t mask = (scalar[0] & 1) - 1;
+    uECC_word_t degenerate = 0;
+    bitcount_t i;
+    wordcount_t j;
+
+    /* k = scalar or scalar + n, whichever is odd; it has at most num_n_bits + 1 bits. */
+    for (j = 0; j < num_n_words; ++j) {
+        k[j] = curve->n[j] & mask;
+    }
+    k[num_n_words] = uECC_vli_add(k, scalar, k, num_n_words);
+
+    regular_lookup(r[0], r[1], table, k, num_windows - 1, window, num_windows, 0, curve);
+    if (initial_Z) {
+        uECC_vli_set(r[2], initial_Z, num_words);
+        apply_z(r[0], r[1], r[2], curve);
+    } else {
+        uECC_vli_clear(r[2], num_words);
+        r[2][0] = 1;
+    }
+
+    for (i = num_windows - 2; i >= 0; --i) {
+        for (j = 0; j < window; ++j) {
+            curve->double_jacobian(r[0], r[1], r[2], curve);
+        }
+        regular_lookup(tx, ty, table, k, i, window, num_windows, 0, curve);
+        degenerate |= add_jacobian_affine(r[0], r[1], r[2], tx, ty, curve);
+    }
+
+    if (degenerate) {
+        return 0;
+    }
+    if (result_Z) {
+        uECC_vli_set(result_Z, r[2], num_words);
+    } else {
+        curve->mod_inv(r[2], r[2], curve);
+        apply_z(r[0], r[1], r[2], curve);
+    }
+    uECC_vli_set(result, r[0], num_words);
+    uECC_vli_set(result + num_words, r[1], num_words);
+    return 1;
+}
+
+
+#if uECC_GLV_secp256k1
+
+/* Window width of the regular recoding in EccPoint_mult_glv() when the table is built for a
+   single multiplication; it then has the same size as the one for the public key in
+   uECC_verify(). The halves of the scalar are less than 2^128, and become at most 2^128 when
+   made odd, so they take GLV_NUM_WINDOWS(w) windows of w bits. */
+#define GLV_WINDOW (Q_WNAF_WINDOW - 1)
+#define GLV_BITS 129
+#define GLV_NUM_WINDOWS(w) ((GLV_BITS + (w) - 1) / (w))
+
+/* Loads the digit for 'window' of the odd value k into (x, y): the point from table (holding the
+   odd multiples of P) is negated if the digit is negative or (exclusive) 'negate' is 1, and
+   multiplied by lambda if 'lambda' is 1. */
+static void glv_lookup(uECC_word_t *x,
+                       uECC_word_t *y,
+                       const uECC_word_t *table,
+                       const uECC_word_t *k,
+                       bitcount_t window,
+                       bitcount_t w,
+                       uECC_word_t negate,
+                       uECC_word_t lambda,
+                       uECC_Curve curve) {
+    regular_lookup(x, y, table, k, window, w, GLV_NUM_WINDOWS(w), negate, curve);
+    if (lambda) {
+        uECC_vli_modMult_fast(x, x, secp256k1_beta, curve);
+    }
+}
+
+/* Computes result = scalar * P on secp256k1 in constant time, where table holds the
+   2^(w - 1) odd multiples of P in affine coordinates. Uses scalar = k1 + k2 * lambda (mod n)
+   (see split_scalar_secp256k1()). Even halves are made odd by adding 1, and the extra point is
+   subtracted at the end. Both halves are then written in a regular signed-digit form with
+   GLV_NUM_WINDOWS(w) odd digits, so that k1 * P and k2 * (lambda * P) share all the doublings
+   and take one addition per window each.
+
+   If x_scale is not 0, only the x coordinate of the result is computed, divided by x_scale.
+   Otherwise, if result_Z is not 0, the result is left in Jacobian coordinates, with its Z value
+   in result_Z.
+
+   Returns 0 if an exceptional case of the addition formula was hit, which only happens
+   for specially constructed inputs; result is then left untouched and the caller should use
+   EccPoint_mult(). */
+static uECC_word_t EccPoint_mult_glv(uECC_word_t * result,
+                                     const uECC_word_t * table,
+                                     bitcount_t w,
+                                     const uECC_word_t * scalar,
+                                     const uECC_word_t * initial_Z,
+                                     const uECC_word_t * x_scale,
+                                     uECC_word_t * result_Z,
+                                     uECC_Curve curve) {
+    uECC_word_t k[2][num_words_secp256k1];
+    uECC_word_t neg[2];
+    uECC_word_t r[3][num_words_secp256k1];
+    uECC_word_t s[3][num_words_secp256k1];
+    uECC_word_t tx[num_words_secp256k1];
+    uECC_word_t ty[num_words_secp256k1];
+    uECC_word_t skew;
+    uECC_word_t mask;
+    uECC_word_t degenerate = 0;
+    bitcount_t num_windows = GLV_NUM_WINDOWS(w);
+    bitcount_t i;
+    wordcount_t h, j;
+
+    split_scalar_secp256k1(k[0], k[1], neg, scalar);
+
+    glv_lookup(r[0], r[1], table, k[0], num_windows - 1, w, neg[0], 0, curve);
+    if (initial_Z) {
+        uECC_vli_set(r[2], initial_Z, num_words_secp256k1);
+        apply_z(r[0], r[1], r[2], curve);
+    } else {
+        uECC_vli_clear(r[2], num_words_secp256k1);
+        r[2][0] = 1;
+    }
+    glv_lookup(tx, ty, table, k[1], num_windows - 1, w, neg[1], 1, curve);
+    degenerate |= add_jacobian_affine(r[0], r[1], r[2], tx, ty, curve);
+
+    for (i = num_windows - 2; i >= 0; --i) {
+        for (j = 0; j < w; ++j) {
+            curve->double_jacobian(r[0], r[1], r[2], curve);
+        }
+        for (h = 0; h < 2; ++h) {
+            glv_lookup(tx, ty, table, k[h], i, w, neg[h], h, curve);
+            degenerate |= add_jacobian_affine(r[0], r[1], r[2], tx, ty, curve);
+        }
+    }
+
+    /* The digits only used bit 0 of k1 and k2 as if it was set. Where it was not, subtract
+       P (or lambda * P) with the sign of that half. */
+    for (h = 0; h < 2; ++h) {
+        skew = (k[h][0] & 1) ^ 1;
+        for (j = 0; j < 3; ++j) {
+            uECC_vli_set(s[j], r[j], num_words_secp256k1);
+        }
+        table_lookup(tx, ty, table, 1, 0, neg[h] ^ 1, curve);
+        if (h) {
+            uECC_vli_modMult_fast(tx, tx, secp256k1_beta, curve);
+        }
+        degenerate |= add_jacobian_affine(s[0], s[1], s[2], tx, ty, curve) & skew;
+        mask = -skew;
+        for (j = 0; j < num_words_secp256k1; ++j) {
+            r[0][j] ^= (r[0][j] ^ s[0][j]) & mask;
+            r[1][j] ^= (r[1][j] ^ s[1][j]) & mask;
+            r[2][j] ^= (r[2][j] ^ s[2][j]) & mask;
+        }
+    }
+
+    if (degenerate) {
+        return 0;
+    }
+    if (x_scale) {
+        uECC_vli_modSquare_fast(r[2], r[2], curve);
+        uECC_vli_modMult_fast(r[2], r[2], x_scale, curve);
+        curve->mod_inv(r[2], r[2], curve);
+        uECC_vli_modMult_fast(result, r[0], r[2], curve);
+        return 1;
+    }
+    if (result_Z) {
+        uECC_vli_set(result_Z, r[2], num_words_secp256k1);
+    } else {
+        curve->mod_inv(r[2], r[2], curve);
+        apply_z(r[0], r[1], r[2], curve);
+    }
+    uECC_vli_set(result, r[0], num_words_secp256k1);
+    uECC_vli_set(result + num_words_secp256k1, r[1], num_words_secp256k1);
+    return 1;
+}
+
+#endif /* uECC_GLV_secp256k1 */
+
+static uECC_word_t regularize_k(const uECC_word_t * const k,
+                                uECC_word_t *k0,
+                                uECC_word_t *k1,
+                                uECC_Curve curve) {
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t num_n_bits = curve->num_n_bits;
+    uECC_word_t carry = uECC_vli_add(k0, k, curve->n, num_n_words) ||
+        (num_n_bits < ((bitcount_t)num_n_words * uECC_WORD_SIZE * 8) &&
+         uECC_vli_testBit(k0, num_n_bits));
+    uECC_vli_add(k1, k0, curve->n, num_n_words);
+    return carry;
+}
+
+/* Computes point = scalar * point in constant time, for scalar < 2^num_n_bits. Uses the GLV
+   method on secp256k1 and the fixed window elsewhere, and the co-Z ladder (with a regularized
+   bitcount for the scalar) if those are disabled or hit an exceptional case. If table is not 0,
+   it holds the 2^(window - 1) odd multiples of point; otherwise the table is built here.
+   initial_Z is as for EccPoint_mult(). If result_Z is not 0, the result may be left in Jacobian
+   coordinates, with its Z value in result_Z (which is set to 1 otherwise), so that the caller
+   can invert the Z values of several results together. */
+static void EccPoint_mult_secret(uECC_word_t * point,
+                                 const uECC_word_t * table,
+                                 bitcount_t window,
+                                 const uECC_word_t * scalar,
+                                 const uECC_word_t * initial_Z,
+                                 uECC_word_t * result_Z,
+                                 uECC_Curve curve) {
+#if uECC_MULT_WINDOW || uECC_GLV_secp256k1
+    uECC_word_t local_table[MAX_TABLE_SIZE * uECC_MAX_WORDS * 2];
+#endif
+    uECC_word_t tmp1[uECC_MAX_WORDS];
+    uECC_word_t tmp2[uECC_MAX_WORDS];
+    uECC_word_t *p2[2] = {tmp1, tmp2};
+    uECC_word_t carry;
+    uECC_word_t done = 0;
+
+#if uECC_MULT_WINDOW || uECC_GLV_secp256k1
+    if (!table) {
+        window = uECC_MULT_WINDOW;
+    #if uECC_GLV_secp256k1
+        if (curve == &curve_secp256k1) {
+            window = GLV_WINDOW;
+        }
+    #endif
+        if (window) {
+            wnaf_table(local_table, point, (wordcount_t)1 << (window - 1), curve);
+            table = local_table;
+        }
+    }
+#endif
+    if (table) {
+#if uECC_GLV_secp256k1
+        if (curve == &curve_secp256k1) {
+            done = EccPoint_mult_glv(point, table, window, scalar, initial_Z, 0, result_Z,
+                                     curve);
+        } else
+#endif
+        done = EccPoint_mult_table(point, table, window, scalar, initial_Z, result_Z, curve);
+    }
+    if (done) {
+        return;
+    }
+    if (result_Z) {
+        uECC_vli_clear(result_Z, curve->num_words);
+        result_Z[0] = 1;
+    }
+
+    /* Regularize the bitcount for the scalar so that attackers cannot use a side channel
+       attack to learn the number of leading zeros. */
+    carry = regularize_k(scalar, tmp1, tmp2, curve);
+    EccPoint_mult(point, point, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+}
+
+#if uECC_ENABLE_VLI_API || uECC_SHARED_SECRET_BATCH_SIZE
+
+/* Largest number of points that EccPoint_mult_batch() multiplies one at a time before
+   inverting their Z values together. */
+#define MULT_BATCH_CHUNK 8
+
+#if (uECC_AVX2_LANES || uECC_IFMA_LANES)
+/* Computes results[j] = scalars[j] * points[j] for one group of 4 (AVX2) or 8 (IFMA) points,
+   running their co-Z ladders in the vector lanes and combining their final inversions into
+   one. The arrays are laid out as for EccPoint_mult_batch(). */
+static void EccPoint_mult_lanes(uECC_word_t *results,
+                                const uECC_word_t *points,
+                                const uECC_word_t *scalars,
+                                uECC_word_t *initial_Z,
+                                unsigned lanes,
+                                uECC_Curve curve) {
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    uECC_word_t Rx[8][2][uECC_MAX_WORDS];
+    uECC_word_t Ry[8][2][uECC_MAX_WORDS];
+    uECC_word_t k[8][uECC_MAX_WORDS];
+    uECC_word_t z[8][uECC_MAX_WORDS];
+    uECC_word_t products[8][uECC_MAX_WORDS];
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t *p2[2];
+    uECC_word_t nb[8];
+    uECC_word_t is_zero[8];
+    const uECC_word_t *point;
+    uECC_word_t *result;
+    unsigned j;
+
+    for (j = 0; j < lanes; ++j) {
+        point = points + j * num_words * 2;
+        uECC_vli_set(Rx[j][1], point, num_words);
+        uECC_vli_set(Ry[j][1], point + num_words, num_words);
+        /* Regularize the bitcount of the scalar, as in EccPoint_mult_secret(). */
+        p2[0] = k[j];
+        p2[1] = tmp;
+        uECC_vli_set(k[j], p2[!regularize_k(scalars + j * num_n_words, k[j], tmp, curve)],
+                     num_n_words);
+    }
+#if uECC_IFMA_LANES
+    if (lanes == 8) {
+        XYcZ_ladder_ifma(Rx, Ry, nb, k, (uECC_word_t (*)[uECC_MAX_WORDS])initial_Z,
+                         curve->num_n_bits + 1, curve);
+    }
+#endif
+#if uECC_AVX2_LANES
+    if (lanes == 4) {
+        XYcZ_ladder_avx2(Rx, Ry, nb, k, (uECC_word_t (*)[uECC_MAX_WORDS])initial_Z,
+                         curve->num_n_bits + 1, curve);
+    }
+#endif
+
+    /* Find the final 1/Z values, as in EccPoint_mult(). */
+    for (j = 0; j < lanes; ++j) {
+        point = points + j * num_words * 2;
+        uECC_vli_modSub(z[j], Rx[j][1], Rx[j][0], curve->p, num_words);
+        uECC_vli_modMult_fast(z[j], z[j], Ry[j][1 - nb[j]], curve);
+        uECC_vli_modMult_fast(z[j], z[j], point, curve);
+        is_zero[j] = uECC_vli_isZero(z[j], num_words);
+        z[j][0] |= is_zero[j];
+    }
+    batch_mod_inv(z[0], lanes, products[0], 0, curve);
+    for (j = 0; j < lanes; ++j) {
+        point = points + j * num_words * 2;
+        result = results + j * num_words * 2;
+        if (is_zero[j]) {
+            /* The ladder meets the point at infinity for a few scalars (such as 1); those
+               points are done again by EccPoint_mult_secret(). */
+            uECC_vli_set(result, point, num_words * 2);
+            EccPoint_mult_secret(result, 0, 0, scalars + j * num_n_words, 0, 0, curve);
+            continue;
+        }
+        uECC_vli_modMult_fast(z[j], z[j], point + num_words, curve);
+        uECC_vli_modMult_fast(z[j], z[j], Rx[j][1 - nb[j]], curve);
+        XYcZ_add(Rx[j][nb[j]], Ry[j][nb[j]], Rx[j][1 - nb[j]], Ry[j][1 - nb[j]], tmp, curve);
+        apply_z(Rx[j][0], Ry[j][0], z[j], curve);
+        uECC_vli_set(result, Rx[j][0], num_words);
+        uECC_vli_set(result + num_words, Ry[j][0], num_words);
+    }
+}
+#endif /* (uECC_AVX2_LANES || uECC_IFMA_LANES) */
+
+/* Computes results[i] = scalars[i] * points[i] for count points, like EccPoint_mult_secret().
+   points and results hold the points one after the other (and may be the same array), and the
+   scalars are BITS_TO_WORDS(curve->num_n_bits) words apart. initial_Z, if not 0, holds count
+   initial Z values (uECC_MAX_WORDS apart) as for EccPoint_mult(). With the IFMA or AVX2 engine,
+   points go through EccPoint_mult_lanes() eight or four at a time; the remaining points are
+   multiplied one at a time, leaving their results in Jacobian coordinates, and brought to
+   affine coordinates MULT_BATCH_CHUNK at a time with a single inversion. */
+static void EccPoint_mult_batch(uECC_word_t *results,
+                                const uECC_word_t *points,
+                                const uECC_word_t *scalars,
+                                uECC_word_t *initial_Z,
+                                unsigned count,
+                                uECC_Curve curve) {
+    uECC_word_t z[MULT_BATCH_CHUNK][uECC_MAX_WORDS];
+    uECC_word_t products[MULT_BATCH_CHUNK][uECC_MAX_WORDS];
+    uECC_word_t is_zero[MULT_BATCH_CHUNK];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    uECC_word_t *result;
+    unsigned i = 0;
+    unsigned j;
+    unsigned n;
+
+#if uECC_IFMA_LANES
+    if (ifma_curve(curve) && ifma_supported()) {
+        for (; i + 8 <= count; i += 8) {
+            EccPoint_mult_lanes(results + i * num_words * 2, points + i * num_words * 2,
+                                scalars + i * num_n_words,
+                                initial_Z ? initial_Z + i * uECC_MAX_WORDS : 0, 8, curve);
+        }
+    }
+#endif
+#if uECC_AVX2_LANES
+    if (avx2_curve(curve) && avx2_supported()) {
+        for (; i + 4 <= count; i += 4) {
+            EccPoint_mult_lanes(results + i * num_words * 2, points + i * num_words * 2,
+                                scalars + i * num_n_words,
+                                initial_Z ? initial_Z + i * uECC_MAX_WORDS : 0, 4, curve);
+        }
+    }
+#endif
+    for (; i < count; i += n) {
+        n = (count - i < MULT_BATCH_CHUNK ? count - i : MULT_BATCH_CHUNK);
+        for (j = 0; j < n; ++j) {
+            result = results + (i + j) * num_words * 2;
+            uECC_vli_set(result, points + (i + j) * num_words * 2, num_words * 2);
+            EccPoint_mult_secret(result, 0, 0, scalars + (i + j) * num_n_words,
+                                 initial_Z ? initial_Z + (i + j) * uECC_MAX_WORDS : 0, z[j],
+                                 curve);
+            /* A result at infinity (for a scalar that is a multiple of n) has Z = 0, and is
+               left as (0, 0) as it would be by a single inversion. */
+            is_zero[j] = uECC_vli_isZero(z[j], num_words);
+            z[j][0] |= is_zero[j];
+        }
+        batch_mod_inv(z[0], n, products[0], 0, curve);
+        for (j = 0; j < n; ++j) {
+            result = results + (i + j) * num_words * 2;
+            z[j][0] &= ~is_zero[j];
+            apply_z(result, result + num_words, z[j], curve);
+        }
+    }
+}
+#endif /* uECC_ENABLE_VLI_API || uECC_SHARED_SECRET_BATCH_SIZE */
+
+/* Generates a random integer in the range 0 < random < top.
+   Both random and top have num_words words. */
+uECC_VLI_API int uECC_generate_random_int(uECC_word_t *random,
+                                          const uECC_word_t *top,
+                                          wordcount_t num_words) {
+    uECC_word_t mask = (uECC_word_t)-1;
+    uECC_word_t tries;
+    bitcount_t num_bits = uECC_vli_numBits(top, num_words);
+
+    if (!g_rng_function) {
         return 0;
     }
 
@@ -965,16 +2850,87 @@ static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
         if (!uECC_generate_random_int(p2[carry], curve->p, curve->num_words)) {
             return 0;
         }
-        initial_Z = p2[carry];
+        initial_Z = p2[carry];
+    }
+
+#if uECC_G_COMB_TEETH
+    if (!comb_skips_scalar(private_key, curve) &&
+            EccPoint_mult_G(result, private_key, initial_Z, 0, curve)) {
+        return 1;
+    }
+#endif
+    EccPoint_mult(result, curve->G, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+
+    if (EccPoint_isZero(result, curve)) {
+        return 0;
+    }
+    return 1;
+}
+
+#if uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE || uECC_MAKE_KEY_BATCH_SIZE || \
+    uECC_KEY_POOL_SIZE || uECC_SHARED_SECRET_BATCH_SIZE
+
+/* Brings count random values (uECC_MAX_WORDS apart) into the range 0 < value < top, as
+   uECC_generate_random_int() does: the values are masked to the bit length of top, and the few
+   that are still out of range are drawn again by uECC_generate_random_int(). */
+static int random_ints_in_range(uECC_word_t *values,
+                                unsigned count,
+                                const uECC_word_t *top,
+                                wordcount_t num_words) {
+    uECC_word_t mask = (uECC_word_t)-1;
+    bitcount_t num_bits = uECC_vli_numBits(top, num_words);
+    uECC_word_t *value;
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        value = values + i * uECC_MAX_WORDS;
+        value[num_words - 1] &= mask >> ((bitcount_t)(num_words * uECC_WORD_SIZE * 8 - num_bits));
+        if ((uECC_vli_isZero(value, num_words) || uECC_vli_cmp(top, value, num_words) != 1) &&
+                !uECC_generate_random_int(value, top, num_words)) {
+            return 0;
+        }
     }
-    EccPoint_mult(result, curve->G, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+    return 1;
+}
 
-    if (EccPoint_isZero(result, curve)) {
+#endif /* uECC_SIGN_BATCH_SIZE || ... || uECC_SHARED_SECRET_BATCH_SIZE */
+
+#if uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE || uECC_MAKE_KEY_BATCH_SIZE || \
+    uECC_KEY_POOL_SIZE
+
+/* Fills count private keys k and then count initial Z values z (uECC_MAX_WORDS apart, in values)
+   with random integers in the ranges 0 < k < n and 0 < z < p, like uECC_generate_random_int(),
+   but with a single call to the RNG function for all of them. */
+static int generate_random_ints(uECC_word_t *values, unsigned count, uECC_Curve curve) {
+    if (!g_rng_function ||
+            !g_rng_function((uint8_t *)values, 2 * count * uECC_MAX_WORDS * uECC_WORD_SIZE)) {
         return 0;
     }
+    return (random_ints_in_range(values, count, curve->n, BITS_TO_WORDS(curve->num_n_bits)) &&
+            random_ints_in_range(values + count * uECC_MAX_WORDS, count, curve->p,
+                                 curve->num_words));
+}
+
+/* Computes point = k * G for 0 < k < n, in Jacobian coordinates with its Z value in z when the
+   comb is used (z is set to 1 otherwise), so that the points of a batch call can be brought to
+   affine coordinates together. z holds a random initial Z value on entry, as in
+   EccPoint_compute_public_key(). Returns 0 if an error occurred. */
+static int batch_mult_G(uECC_word_t *point, uECC_word_t *z, uECC_word_t *k, uECC_Curve curve) {
+#if uECC_G_COMB_TEETH
+    if (EccPoint_mult_G(point, k, z, z, curve)) {
+        return 1;
+    }
+#endif
+    if (!EccPoint_compute_public_key(point, k, curve)) {
+        return 0;
+    }
+    uECC_vli_clear(z, curve->num_words);
+    z[0] = 1;
     return 1;
 }
 
+#endif /* uECC_SIGN_BATCH_SIZE || ... || uECC_KEY_POOL_SIZE */
+
 #if uECC_WORD_SIZE == 1
 
 uECC_VLI_API void uECC_vli_nativeToBytes(uint8_t *bytes,
@@ -1048,6 +3004,262 @@ int uECC_make_key(uint8_t *public_key,
     return 0;
 }
 
+/* Spacing of the private keys in the output of a batch. In native little-endian mode the private
+   keys are read and written as words, so each one is padded to whole words. */
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    #define BATCH_PRIVATE_SIZE(curve) (BITS_TO_WORDS((curve)->num_n_bits) * uECC_WORD_SIZE)
+#else
+    #define BATCH_PRIVATE_SIZE(curve) BITS_TO_BYTES((curve)->num_n_bits)
+#endif
+
+#if uECC_MAKE_KEY_BATCH_SIZE || uECC_KEY_POOL_SIZE
+
+/* Largest number of key pairs that make_key_batch() computes at once. */
+#if uECC_MAKE_KEY_BATCH_SIZE
+    #define KEY_BATCH_SIZE uECC_MAKE_KEY_BATCH_SIZE
+#else
+    #define KEY_BATCH_SIZE 1
+#endif
+
+/* Generates count <= KEY_BATCH_SIZE key pairs, as uECC_make_key() does, one after another in
+   public_keys and private_keys. All the private keys and initial Z values are drawn with one call
+   to the RNG function; the public keys are computed in Jacobian coordinates and then all brought
+   to affine coordinates with a single field inversion. ok[i] is set to 0 if key pair i could not
+   be generated (if the RNG failed). */
+static void make_key_batch(uint8_t *public_keys,
+                           uint8_t *private_keys,
+                           uint8_t *ok,
+                           unsigned count,
+                           uECC_Curve curve) {
+    uECC_word_t k[KEY_BATCH_SIZE * 2][uECC_MAX_WORDS];
+    uECC_word_t (*z)[uECC_MAX_WORDS] = k + count;
+    uECC_word_t points[KEY_BATCH_SIZE][uECC_MAX_WORDS * 2];
+    uECC_word_t products[KEY_BATCH_SIZE][uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_bytes = curve->num_bytes;
+    int private_size = BATCH_PRIVATE_SIZE(curve);
+    uint8_t *public_key;
+    uint8_t *private_key;
+    unsigned i;
+    int have_random = generate_random_ints(k[0], count, curve);
+
+    for (i = 0; i < count; ++i) {
+        ok[i] = (have_random && batch_mult_G(points[i], z[i], k[i], curve));
+        if (!ok[i]) {
+            /* Keep the values to invert nonzero. */
+            uECC_vli_clear(z[i], num_words);
+            z[i][0] = 1;
+        }
+    }
+
+    batch_mod_inv(z[0], count, products[0], 0, curve);
+    for (i = 0; i < count; ++i) {
+        if (ok[i]) {
+            apply_z(points[i], points[i] + num_words, z[i], curve);
+            public_key = public_keys + i * num_bytes * 2;
+            private_key = private_keys + i * private_size;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(private_key, (uint8_t *) k[i], private_size);
+            bcopy(public_key, (uint8_t *) points[i], num_bytes);
+            bcopy(public_key + num_bytes, (uint8_t *) (points[i] + num_words), num_bytes);
+#else
+            uECC_vli_nativeToBytes(private_key, private_size, k[i]);
+            uECC_vli_nativeToBytes(public_key, num_bytes, points[i]);
+            uECC_vli_nativeToBytes(public_key + num_bytes, num_bytes, points[i] + num_words);
+#endif
+        }
+    }
+    pool_wipe(k, sizeof(k));
+}
+
+#endif /* uECC_MAKE_KEY_BATCH_SIZE || uECC_KEY_POOL_SIZE */
+
+/* The arguments of a uECC_make_key_batch() call, for make_key_batch_part(). */
+typedef struct make_key_batch_args_t {
+    uint8_t *public_keys;
+    uint8_t *private_keys;
+    uECC_Curve curve;
+} make_key_batch_args_t;
+
+#if uECC_MAKE_KEY_BATCH_SIZE
+
+/* Generates key pairs start to start + count - 1 of a uECC_make_key_batch() call, for
+   count <= uECC_MAKE_KEY_BATCH_SIZE (a batch_part_t), with make_key_batch(). Key pairs that
+   cannot be generated that way are generated again by uECC_make_key(). */
+static int make_key_batch_part(const void *args,
+                               unsigned start,
+                               unsigned count,
+                               uint8_t *results) {
+    uint8_t ok[uECC_MAKE_KEY_BATCH_SIZE];
+    const make_key_batch_args_t *batch = (const make_key_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    unsigned public_size = curve->num_bytes * 2;
+    unsigned private_size = BATCH_PRIVATE_SIZE(curve);
+    uint8_t *public_keys = batch->public_keys + start * public_size;
+    uint8_t *private_keys = batch->private_keys + start * private_size;
+    unsigned i;
+    int all_ok = 1;
+
+    make_key_batch(public_keys, private_keys, ok, count, curve);
+    for (i = 0; i < count; ++i) {
+        if (!ok[i]) {
+            ok[i] = (uint8_t)uECC_make_key(public_keys + i * public_size,
+                                           private_keys + i * private_size, curve);
+        }
+        if (results) {
+            results[i] = ok[i];
+        }
+        all_ok &= ok[i];
+    }
+    return all_ok;
+}
+
+#else /* !uECC_MAKE_KEY_BATCH_SIZE */
+
+/* Generates key pairs start to start + count - 1 of a uECC_make_key_batch() call one at a time
+   (a batch_part_t). */
+static int make_key_batch_part(const void *args,
+                               unsigned start,
+                               unsigned count,
+                               uint8_t *results) {
+    const make_key_batch_args_t *batch = (const make_key_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    unsigned public_size = curve->num_bytes * 2;
+    unsigned private_size = BATCH_PRIVATE_SIZE(curve);
+    unsigned i;
+    int all_ok = 1;
+    int ok;
+
+    for (i = start; i < start + count; ++i) {
+        ok = uECC_make_key(batch->public_keys + i * public_size,
+                           batch->private_keys + i * private_size, curve);
+        if (results) {
+            results[i - start] = (uint8_t)ok;
+        }
+        all_ok &= ok;
+    }
+    return all_ok;
+}
+
+#endif /* uECC_MAKE_KEY_BATCH_SIZE */
+
+int uECC_make_key_batch(uint8_t *public_keys,
+                        uint8_t *private_keys,
+                        unsigned count,
+                        uECC_Curve curve) {
+    make_key_batch_args_t args;
+
+    args.public_keys = public_keys;
+    args.private_keys = private_keys;
+    args.curve = curve;
+#if uECC_MAKE_KEY_BATCH_SIZE
+    return run_batch(&make_key_batch_part, &args, count, uECC_MAKE_KEY_BATCH_SIZE, 0);
+#else
+    return run_batch(&make_key_batch_part, &args, count, BATCH_MAX_PART, 0);
+#endif
+}
+
+#if uECC_KEY_POOL_SIZE
+
+void uECC_key_pool_init(uECC_KeyPool *pool,
+                        uECC_Curve curve,
+                        unsigned low_watermark,
+                        uECC_Watermark_Function callback,
+                        void *context) {
+    unsigned i;
+
+    pool->curve = curve;
+    pool->head = 0;
+    pool->tail = 0;
+    pool->misses = 0;
+    pool->low_watermark = low_watermark;
+    pool->callback = callback;
+    pool->context = context;
+    pool_wipe(pool->keys, sizeof(pool->keys));
+    for (i = 0; i < uECC_KEY_POOL_SIZE; ++i) {
+        pool->sequence[i] = i;
+    }
+}
+
+unsigned uECC_key_pool_available(const uECC_KeyPool *pool) {
+    return pool_count(&pool->head, &pool->tail, uECC_KEY_POOL_SIZE);
+}
+
+unsigned uECC_key_pool_misses(const uECC_KeyPool *pool) {
+    return pool_load(&pool->misses);
+}
+
+unsigned uECC_key_pool_refill(uECC_KeyPool *pool, unsigned max_count) {
+    uint8_t public_keys[KEY_BATCH_SIZE * uECC_MAX_COORDINATE_BYTES * 2];
+    uint8_t private_keys[KEY_BATCH_SIZE * uECC_MAX_WORDS * uECC_WORD_SIZE];
+    uint8_t ok[KEY_BATCH_SIZE];
+    uECC_Curve curve = pool->curve;
+    int public_size = curve->num_bytes * 2;
+    int private_size = BITS_TO_BYTES(curve->num_n_bits);
+    int private_stride = BATCH_PRIVATE_SIZE(curve);
+    uint8_t *key;
+    unsigned count = uECC_KEY_POOL_SIZE - uECC_key_pool_available(pool);
+    unsigned added = 0;
+    unsigned position;
+    unsigned i;
+    int claimed = 1;
+
+    count = (count < max_count ? count : max_count);
+    count = (count < KEY_BATCH_SIZE ? count : KEY_BATCH_SIZE);
+    if (!count) {
+        return 0;
+    }
+
+    make_key_batch(public_keys, private_keys, ok, count, curve);
+    for (i = 0; i < count && claimed; ++i) {
+        if (ok[i]) {
+            position = pool_claim(&pool->head, pool->sequence, uECC_KEY_POOL_SIZE, 1, &claimed);
+            if (claimed) {
+                key = pool->keys[position % uECC_KEY_POOL_SIZE];
+                pool_copy(key, public_keys + i * public_size, public_size);
+                pool_copy(key + public_size, private_keys + i * private_stride, private_size);
+                pool_store(&pool->sequence[position % uECC_KEY_POOL_SIZE], position + 1);
+                ++added;
+            }
+        }
+    }
+    pool_wipe(private_keys, sizeof(private_keys));
+    return added;
+}
+
+int uECC_key_pool_take(uECC_KeyPool *pool, uint8_t *public_key, uint8_t *private_key) {
+    uECC_Curve curve = pool->curve;
+    int public_size = curve->num_bytes * 2;
+    uint8_t *key;
+    unsigned position;
+    int claimed;
+    int success = 1;
+
+    position = pool_claim(&pool->tail, pool->sequence, uECC_KEY_POOL_SIZE, 0, &claimed);
+    if (claimed) {
+        key = pool->keys[position % uECC_KEY_POOL_SIZE];
+        pool_copy(public_key, key, public_size);
+        pool_copy(private_key, key + public_size, BITS_TO_BYTES(curve->num_n_bits));
+        pool_wipe(key, sizeof(pool->keys[0]));
+        pool_store(&pool->sequence[position % uECC_KEY_POOL_SIZE],
+                   position + uECC_KEY_POOL_SIZE);
+    } else {
+        pool_increment(&pool->misses);
+        success = uECC_make_key(public_key, private_key, curve);
+    }
+
+    if (pool->callback && uECC_key_pool_available(pool) <= pool->low_watermark) {
+        pool->callback(pool->context);
+    }
+    return success;
+}
+
+void uECC_key_pool_release(const uECC_KeyPool *pool, uint8_t *private_key) {
+    pool_wipe(private_key, BITS_TO_BYTES(pool->curve->num_n_bits));
+}
+
+#endif /* uECC_KEY_POOL_SIZE */
+
 int uECC_shared_secret(const uint8_t *public_key,
                        const uint8_t *private_key,
                        uint8_t *secret,
@@ -1056,14 +3268,14 @@ int uECC_shared_secret(const uint8_t *public_key,
     uECC_word_t _private[uECC_MAX_WORDS];
 
     uECC_word_t tmp[uECC_MAX_WORDS];
-    uECC_word_t *p2[2] = {_private, tmp};
     uECC_word_t *initial_Z = 0;
-    uECC_word_t carry;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_bytes = curve->num_bytes;
 
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    bcopy((uint8_t *) _private, private_key, num_bytes);
+    uECC_vli_clear(_private, BITS_TO_WORDS(curve->num_n_bits));
+    uECC_vli_clear(_public, num_words * 2);
+    bcopy((uint8_t *) _private, private_key, BITS_TO_BYTES(curve->num_n_bits));
     bcopy((uint8_t *) _public, public_key, num_bytes*2);
 #else
     uECC_vli_bytesToNative(_private, private_key, BITS_TO_BYTES(curve->num_n_bits));
@@ -1071,9 +3283,67 @@ int uECC_shared_secret(const uint8_t *public_key,
     uECC_vli_bytesToNative(_public + num_words, public_key + num_bytes, num_bytes);
 #endif
 
+    /* If an RNG function was specified, try to get a random initial Z value to improve
+       protection against side-channel attacks. */
+    if (g_rng_function) {
+        if (!uECC_generate_random_int(tmp, curve->p, num_words)) {
+            return 0;
+        }
+        initial_Z = tmp;
+    }
+
+    EccPoint_mult_secret(_public, 0, 0, _private, initial_Z, 0, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) secret, (uint8_t *) _public, num_bytes);
+#else
+    uECC_vli_nativeToBytes(secret, num_bytes, _public);
+#endif
+    return !EccPoint_isZero(_public, curve);
+}
+
+int uECC_shared_secret_x(const uint8_t *public_x,
+                         const uint8_t *private_key,
+                         uint8_t *secret,
+                         uECC_Curve curve) {
+    uECC_word_t x[uECC_MAX_WORDS];
+    uECC_word_t v[uECC_MAX_WORDS];
+    uECC_word_t _private[uECC_MAX_WORDS];
+    uECC_word_t tmp1[uECC_MAX_WORDS];
+    uECC_word_t tmp2[uECC_MAX_WORDS];
+    uECC_word_t *p2[2] = {tmp1, tmp2};
+    uECC_word_t *initial_Z = 0;
+    uECC_word_t carry;
+#if uECC_GLV_secp256k1
+    uECC_word_t point[uECC_MAX_WORDS * 2];
+    uECC_word_t table[WNAF_TABLE_SIZE(Q_WNAF_WINDOW) * num_words_secp256k1 * 2];
+    uECC_word_t done = 0;
+#endif
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_bytes = curve->num_bytes;
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_vli_clear(_private, BITS_TO_WORDS(curve->num_n_bits));
+    uECC_vli_clear(x, num_words);
+    bcopy((uint8_t *) _private, private_key, BITS_TO_BYTES(curve->num_n_bits));
+    bcopy((uint8_t *) x, public_x, num_bytes);
+#else
+    uECC_vli_bytesToNative(_private, private_key, BITS_TO_BYTES(curve->num_n_bits));
+    uECC_vli_bytesToNative(x, public_x, num_bytes);
+#endif
+
+    /* x must be < p, and x^3 + ax + b must be a nonzero square. Otherwise x belongs to a point
+       on the quadratic twist of the curve, and the result would leak the private key. */
+    if (uECC_vli_cmp_unsafe(curve->p, x, num_words) != 1) {
+        return 0;
+    }
+    curve->x_side(v, x, curve);
+    if (vli_jacobi(v, curve) != 1) {
+        return 0;
+    }
+
     /* Regularize the bitcount for the private key so that attackers cannot use a side channel
        attack to learn the number of leading zeros. */
-    carry = regularize_k(_private, _private, tmp, curve);
+    carry = regularize_k(_private, tmp1, tmp2, curve);
 
     /* If an RNG function was specified, try to get a random initial Z value to improve
        protection against side-channel attacks. */
@@ -1084,13 +3354,27 @@ int uECC_shared_secret(const uint8_t *public_key,
         initial_Z = p2[carry];
     }
 
-    EccPoint_mult(_public, _public, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+#if uECC_GLV_secp256k1
+    if (curve == &curve_secp256k1) {
+        /* (x v, v^2) is on Y^2 = X^3 + b v^3, which has the same doubling formula and
+           endomorphism as secp256k1, and maps back with x = X / v. */
+        uECC_vli_modMult_fast(point, x, v, curve);
+        uECC_vli_modSquare_fast(point + num_words, v, curve);
+        wnaf_table(table, point, WNAF_TABLE_SIZE(Q_WNAF_WINDOW), curve);
+        done = EccPoint_mult_glv(x, table, GLV_WINDOW, _private, initial_Z, v, 0, curve);
+    }
+    if (!done) {
+        EccPoint_mult_x(x, x, v, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+    }
+#else
+    EccPoint_mult_x(x, x, v, p2[!carry], initial_Z, curve->num_n_bits + 1, curve);
+#endif
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    bcopy((uint8_t *) secret, (uint8_t *) _public, num_bytes);
+    bcopy((uint8_t *) secret, (uint8_t *) x, num_bytes);
 #else
-    uECC_vli_nativeToBytes(secret, num_bytes, _public);
+    uECC_vli_nativeToBytes(secret, num_bytes, x);
 #endif
-    return !EccPoint_isZero(_public, curve);
+    return !uECC_vli_isZero(x, num_words);
 }
 
 #if uECC_SUPPORT_COMPRESSED_POINT
@@ -1255,37 +3539,27 @@ static int uECC_sign_with_k_internal(const uint8_t *private_key,
 
     uECC_word_t tmp[uECC_MAX_WORDS];
     uECC_word_t s[uECC_MAX_WORDS];
-    uECC_word_t *k2[2] = {tmp, s};
-    uECC_word_t *initial_Z = 0;
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     uECC_word_t *p = (uECC_word_t *)signature;
 #else
     uECC_word_t p[uECC_MAX_WORDS * 2];
 #endif
-    uECC_word_t carry;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-    bitcount_t num_n_bits = curve->num_n_bits;
 
     /* Make sure 0 < k < curve_n */
     if (uECC_vli_isZero(k, num_words) || uECC_vli_cmp(curve->n, k, num_n_words) != 1) {
         return 0;
     }
 
-    carry = regularize_k(k, tmp, s, curve);
-    /* If an RNG function was specified, try to get a random initial Z value to improve
-       protection against side-channel attacks. */
-    if (g_rng_function) {
-        if (!uECC_generate_random_int(k2[carry], curve->p, num_words)) {
-            return 0;
-        }
-        initial_Z = k2[carry];
-    }
-    EccPoint_mult(p, curve->G, k2[!carry], initial_Z, num_n_bits + 1, curve);
-    if (uECC_vli_isZero(p, num_words)) {
+    if (!EccPoint_compute_public_key(p, k, curve) || uECC_vli_isZero(p, num_words)) {
         return 0;
     }
 
+#if SAFEGCD_INVERSE
+    /* uECC_vli_modInv() runs in constant time, so k does not need to be blinded. */
+    uECC_vli_modInv(k, k, curve->n, num_n_words);       /* k = 1 / k */
+#else
     /* If an RNG function was specified, get a random number
        to prevent side channel analysis of k. */
     if (!g_rng_function) {
@@ -1297,70 +3571,403 @@ static int uECC_sign_with_k_internal(const uint8_t *private_key,
 
     /* Prevent side channel analysis of uECC_vli_modInv() to determine
        bits of k / the private key by premultiplying by a random number */
-    uECC_vli_modMult(k, k, tmp, curve->n, num_n_words); /* k' = rand * k */
+    vli_modMult_n(k, k, tmp, curve);                    /* k' = rand * k */
     uECC_vli_modInv(k, k, curve->n, num_n_words);       /* k = 1 / k' */
-    uECC_vli_modMult(k, k, tmp, curve->n, num_n_words); /* k = 1 / k */
+    vli_modMult_n(k, k, tmp, curve);                    /* k = 1 / k */
+#endif
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN == 0
+    uECC_vli_nativeToBytes(signature, curve->num_bytes, p); /* store r */
+#endif
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    tmp[num_n_words - 1] = 0;
+    bcopy((uint8_t *) tmp, private_key, BITS_TO_BYTES(curve->num_n_bits));
+#else
+    uECC_vli_bytesToNative(tmp, private_key, BITS_TO_BYTES(curve->num_n_bits)); /* tmp = d */
+#endif
+
+    s[num_n_words - 1] = 0;
+    uECC_vli_set(s, p, num_words);
+    if (uECC_vli_cmp(curve->n, tmp, num_n_words) == 1) {
+        vli_modMult_n(s, s, tmp, curve); /* s = r*d */
+    } else {
+        /* Private key is not reduced mod n. */
+        uECC_vli_modMult(s, tmp, s, curve->n, num_n_words); /* s = r*d */
+    }
+
+    bits2int(tmp, message_hash, hash_size, curve);
+    uECC_vli_modAdd(s, tmp, s, curve->n, num_n_words); /* s = e + r*d */
+    vli_modMult_n(s, s, k, curve);                     /* s = (e + r*d) / k */
+    if (uECC_vli_numBits(s, num_n_words) > (bitcount_t)curve->num_bytes * 8) {
+        return 0;
+    }
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) signature + curve->num_bytes, (uint8_t *) s, curve->num_bytes);
+#else
+    uECC_vli_nativeToBytes(signature + curve->num_bytes, curve->num_bytes, s);
+#endif
+    return 1;
+}
+
+/* For testing - sign with an explicitly specified k value */
+int uECC_sign_with_k(const uint8_t *private_key,
+                            const uint8_t *message_hash,
+                            unsigned hash_size,
+                            const uint8_t *k,
+                            uint8_t *signature,
+                            uECC_Curve curve) {
+    uECC_word_t k2[uECC_MAX_WORDS];
+    bits2int(k2, k, BITS_TO_BYTES(curve->num_n_bits), curve);
+    return uECC_sign_with_k_internal(private_key, message_hash, hash_size, k2, signature, curve);
+}
+
+int uECC_sign(const uint8_t *private_key,
+              const uint8_t *message_hash,
+              unsigned hash_size,
+              uint8_t *signature,
+              uECC_Curve curve) {
+    uECC_word_t k[uECC_MAX_WORDS];
+    uECC_word_t tries;
+
+    for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
+        if (!uECC_generate_random_int(k, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
+            return 0;
+        }
+
+        if (uECC_sign_with_k_internal(private_key, message_hash, hash_size, k, signature, curve)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#if uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE || uECC_SHARED_SECRET_BATCH_SIZE
+
+/* Decodes private_key into d, reduced mod n. */
+static void load_private_key(uECC_word_t *d, const uint8_t *private_key, uECC_Curve curve) {
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    d[num_n_words - 1] = 0;
+    bcopy((uint8_t *) d, private_key, BITS_TO_BYTES(curve->num_n_bits));
+#else
+    uECC_vli_bytesToNative(d, private_key, BITS_TO_BYTES(curve->num_n_bits));
+#endif
+    if (uECC_vli_cmp(curve->n, d, num_n_words) != 1) {
+        uECC_word_t one[uECC_MAX_WORDS];
+        uECC_vli_clear(one, num_n_words);
+        one[0] = 1;
+        uECC_vli_modMult(d, d, one, curve->n, num_n_words);
+    }
+}
+
+#endif /* uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE || uECC_SHARED_SECRET_BATCH_SIZE */
+
+#if uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE
+
+/* Signs message_hash with the private key d (decoded by load_private_key()), given r (the x
+   coordinate of k * G) and k_inverse (1 / k mod n) for the nonce k, as the end of
+   uECC_sign_with_k_internal() does. Returns 0 if s is out of range; signature is then left
+   unchanged. */
+static int sign_with_nonce(uint8_t *signature,
+                           const uECC_word_t *r,
+                           const uECC_word_t *k_inverse,
+                           const uECC_word_t *d,
+                           const uint8_t *message_hash,
+                           unsigned hash_size,
+                           uECC_Curve curve) {
+    uECC_word_t s[uECC_MAX_WORDS];
+    uECC_word_t e[uECC_MAX_WORDS];
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+    s[num_n_words - 1] = 0;
+    uECC_vli_set(s, r, curve->num_words);
+    vli_modMult_n(s, s, d, curve);                     /* s = r*d */
+    bits2int(e, message_hash, hash_size, curve);
+    uECC_vli_modAdd(s, e, s, curve->n, num_n_words);   /* s = e + r*d */
+    vli_modMult_n(s, s, k_inverse, curve);             /* s = (e + r*d) / k */
+    if (uECC_vli_numBits(s, num_n_words) > (bitcount_t)curve->num_bytes * 8) {
+        return 0;
+    }
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy(signature, (const uint8_t *) r, curve->num_bytes);
+    bcopy(signature + curve->num_bytes, (uint8_t *) s, curve->num_bytes);
+#else
+    uECC_vli_nativeToBytes(signature, curve->num_bytes, r);
+    uECC_vli_nativeToBytes(signature + curve->num_bytes, curve->num_bytes, s);
+#endif
+    return 1;
+}
+
+/* Largest number of nonces that sign_batch_nonces() computes at once. */
+#if uECC_SIGN_BATCH_SIZE
+    #define NONCE_BATCH_SIZE uECC_SIGN_BATCH_SIZE
+#else
+    #define NONCE_BATCH_SIZE 1
+#endif
+
+/* Computes count <= NONCE_BATCH_SIZE signing nonces: for a random k, r[i] is set to the x
+   coordinate of k * G and k_inverse[i] to 1 / k. All the values of k and of the initial Z values
+   are drawn with one call to the RNG function; the Z values of all the points k * G are then
+   inverted together, and so are all the values of k. ok[i] is set to 0 if nonce i could not be
+   computed (if the RNG failed, or r is 0). */
+static void sign_batch_nonces(uECC_word_t (*r)[uECC_MAX_WORDS],
+                              uECC_word_t (*k_inverse)[uECC_MAX_WORDS],
+                              uint8_t *ok,
+                              unsigned count,
+                              uECC_Curve curve) {
+    uECC_word_t k[NONCE_BATCH_SIZE * 2][uECC_MAX_WORDS];
+    uECC_word_t (*z)[uECC_MAX_WORDS] = k + count;
+    uECC_word_t products[NONCE_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t point[uECC_MAX_WORDS * 2];
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned i;
+    int have_random = generate_random_ints(k[0], count, curve);
+
+    for (i = 0; i < count; ++i) {
+        ok[i] = (have_random && batch_mult_G(point, z[i], k[i], curve));
+        uECC_vli_set(r[i], point, num_words);
+        if (!ok[i]) {
+            /* Keep the values to invert nonzero. */
+            uECC_vli_clear(k[i], num_n_words);
+            uECC_vli_clear(z[i], num_words);
+            k[i][0] = 1;
+            z[i][0] = 1;
+        }
+    }
+
+    batch_mod_inv(z[0], count, products[0], 0, curve);
+#if !SAFEGCD_INVERSE
+    /* Blind the product of the k values before it is inverted, as in uECC_sign(); the random
+       factor only ends up in 1 / k[0], which is multiplied by it again. */
+    if (!uECC_generate_random_int(tmp, curve->n, num_n_words)) {
+        for (i = 0; i < count; ++i) {
+            ok[i] = 0;
+        }
+        uECC_vli_clear(tmp, num_n_words);
+        tmp[0] = 1;
+    }
+    vli_modMult_n(k[0], k[0], tmp, curve);
+    batch_mod_inv(k[0], count, products[0], 1, curve);
+    vli_modMult_n(k[0], k[0], tmp, curve);
+#else
+    batch_mod_inv(k[0], count, products[0], 1, curve);
+#endif
+
+    for (i = 0; i < count; ++i) {
+        if (ok[i]) {
+            uECC_vli_modSquare_fast(tmp, z[i], curve);
+            uECC_vli_modMult_fast(r[i], r[i], tmp, curve);  /* r = x / z^2 */
+            ok[i] = !uECC_vli_isZero(r[i], num_words);
+        }
+        uECC_vli_set(k_inverse[i], k[i], num_n_words);
+    }
+    pool_wipe(k, sizeof(k));
+    pool_wipe(products, sizeof(products));
+    pool_wipe(tmp, sizeof(tmp));
+}
+
+#endif /* uECC_SIGN_BATCH_SIZE || uECC_NONCE_POOL_SIZE */
+
+/* The arguments of a uECC_sign_batch() call, for sign_batch_part(). */
+typedef struct sign_batch_args_t {
+    const uint8_t *private_key;
+#if uECC_SIGN_BATCH_SIZE
+    uECC_word_t d[uECC_MAX_WORDS]; /* decoded by load_private_key() */
+#endif
+    const uint8_t *message_hashes;
+    unsigned hash_size;
+    uint8_t *signatures;
+    uECC_Curve curve;
+} sign_batch_args_t;
+
+#if uECC_SIGN_BATCH_SIZE
+
+/* Signs message hashes start to start + count - 1 of a uECC_sign_batch() call, for
+   count <= uECC_SIGN_BATCH_SIZE (a batch_part_t), with nonces from sign_batch_nonces().
+   Entries that cannot be signed that way (if r or s is out of range, or the RNG failed) are
+   signed again by uECC_sign(). */
+static int sign_batch_part(const void *args,
+                           unsigned start,
+                           unsigned count,
+                           uint8_t *results) {
+    uECC_word_t r[uECC_SIGN_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t k_inverse[uECC_SIGN_BATCH_SIZE][uECC_MAX_WORDS];
+    uint8_t ok[uECC_SIGN_BATCH_SIZE];
+    const sign_batch_args_t *batch = (const sign_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    unsigned hash_size = batch->hash_size;
+    const uint8_t *message_hashes = batch->message_hashes + start * hash_size;
+    uint8_t *signatures = batch->signatures + start * curve->num_bytes * 2;
+    uint8_t *signature;
+    unsigned i;
+    int all_ok = 1;
+
+    sign_batch_nonces(r, k_inverse, ok, count, curve);
+    for (i = 0; i < count; ++i) {
+        signature = signatures + i * curve->num_bytes * 2;
+        ok[i] = (ok[i] && sign_with_nonce(signature, r[i], k_inverse[i], batch->d,
+                                          message_hashes + i * hash_size, hash_size, curve));
+        if (!ok[i]) {
+            ok[i] = (uint8_t)uECC_sign(batch->private_key, message_hashes + i * hash_size,
+                                       hash_size, signature, curve);
+        }
+        if (results) {
+            results[i] = ok[i];
+        }
+        all_ok &= ok[i];
+    }
+    pool_wipe(r, sizeof(r));
+    pool_wipe(k_inverse, sizeof(k_inverse));
+    return all_ok;
+}
+
+#else /* !uECC_SIGN_BATCH_SIZE */
+
+/* Signs message hashes start to start + count - 1 of a uECC_sign_batch() call one at a time
+   (a batch_part_t). */
+static int sign_batch_part(const void *args,
+                           unsigned start,
+                           unsigned count,
+                           uint8_t *results) {
+    const sign_batch_args_t *batch = (const sign_batch_args_t *)args;
+    unsigned signature_size = batch->curve->num_bytes * 2;
+    unsigned i;
+    int all_ok = 1;
+    int ok;
+
+    for (i = start; i < start + count; ++i) {
+        ok = uECC_sign(batch->private_key, batch->message_hashes + i * batch->hash_size,
+                       batch->hash_size, batch->signatures + i * signature_size, batch->curve);
+        if (results) {
+            results[i - start] = (uint8_t)ok;
+        }
+        all_ok &= ok;
+    }
+    return all_ok;
+}
 
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN == 0
-    uECC_vli_nativeToBytes(signature, curve->num_bytes, p); /* store r */
-#endif
+#endif /* uECC_SIGN_BATCH_SIZE */
 
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    bcopy((uint8_t *) tmp, private_key, BITS_TO_BYTES(curve->num_n_bits));
+int uECC_sign_batch(const uint8_t *private_key,
+                    const uint8_t *message_hashes,
+                    unsigned hash_size,
+                    unsigned count,
+                    uint8_t *signatures,
+                    uECC_Curve curve) {
+    sign_batch_args_t args;
+
+    args.private_key = private_key;
+    args.message_hashes = message_hashes;
+    args.hash_size = hash_size;
+    args.signatures = signatures;
+    args.curve = curve;
+#if uECC_SIGN_BATCH_SIZE
+    load_private_key(args.d, private_key, curve);
+    return run_batch(&sign_batch_part, &args, count, uECC_SIGN_BATCH_SIZE, 0);
 #else
-    uECC_vli_bytesToNative(tmp, private_key, BITS_TO_BYTES(curve->num_n_bits)); /* tmp = d */
+    return run_batch(&sign_batch_part, &args, count, BATCH_MAX_PART, 0);
 #endif
+}
 
-    s[num_n_words - 1] = 0;
-    uECC_vli_set(s, p, num_words);
-    uECC_vli_modMult(s, tmp, s, curve->n, num_n_words); /* s = r*d */
+#if uECC_NONCE_POOL_SIZE
 
-    bits2int(tmp, message_hash, hash_size, curve);
-    uECC_vli_modAdd(s, tmp, s, curve->n, num_n_words); /* s = e + r*d */
-    uECC_vli_modMult(s, s, k, curve->n, num_n_words);  /* s = (e + r*d) / k */
-    if (uECC_vli_numBits(s, num_n_words) > (bitcount_t)curve->num_bytes * 8) {
-        return 0;
+#define POOL_NONCE_WORDS (2 * uECC_MAX_COORDINATE_BYTES / uECC_WORD_SIZE)
+
+void uECC_nonce_pool_init(uECC_NoncePool *pool, uECC_Curve curve) {
+    unsigned i;
+
+    pool->curve = curve;
+    pool->head = 0;
+    pool->tail = 0;
+    pool_wipe(pool->nonces, sizeof(pool->nonces));
+    for (i = 0; i < uECC_NONCE_POOL_SIZE; ++i) {
+        pool->sequence[i] = i;
     }
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    bcopy((uint8_t *) signature + curve->num_bytes, (uint8_t *) s, curve->num_bytes);
-#else
-    uECC_vli_nativeToBytes(signature + curve->num_bytes, curve->num_bytes, s);
-#endif
-    return 1;
 }
 
-/* For testing - sign with an explicitly specified k value */
-int uECC_sign_with_k(const uint8_t *private_key,
-                            const uint8_t *message_hash,
-                            unsigned hash_size,
-                            const uint8_t *k,
-                            uint8_t *signature,
-                            uECC_Curve curve) {
-    uECC_word_t k2[uECC_MAX_WORDS];
-    bits2int(k2, k, BITS_TO_BYTES(curve->num_n_bits), curve);
-    return uECC_sign_with_k_internal(private_key, message_hash, hash_size, k2, signature, curve);
+unsigned uECC_nonce_pool_available(const uECC_NoncePool *pool) {
+    return pool_count(&pool->head, &pool->tail, uECC_NONCE_POOL_SIZE);
 }
 
-int uECC_sign(const uint8_t *private_key,
-              const uint8_t *message_hash,
-              unsigned hash_size,
-              uint8_t *signature,
-              uECC_Curve curve) {
-    uECC_word_t k[uECC_MAX_WORDS];
-    uECC_word_t tries;
+unsigned uECC_nonce_pool_refill(uECC_NoncePool *pool, unsigned max_count) {
+    uECC_word_t r[NONCE_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t k_inverse[NONCE_BATCH_SIZE][uECC_MAX_WORDS];
+    uint8_t ok[NONCE_BATCH_SIZE];
+    uECC_Curve curve = pool->curve;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    uECC_word_t *nonce;
+    unsigned count = uECC_NONCE_POOL_SIZE - uECC_nonce_pool_available(pool);
+    unsigned added = 0;
+    unsigned position;
+    unsigned i;
+    int claimed = 1;
 
-    for (tries = 0; tries < uECC_RNG_MAX_TRIES; ++tries) {
-        if (!uECC_generate_random_int(k, curve->n, BITS_TO_WORDS(curve->num_n_bits))) {
-            return 0;
+    count = (count < max_count ? count : max_count);
+    count = (count < NONCE_BATCH_SIZE ? count : NONCE_BATCH_SIZE);
+    if (!count) {
+        return 0;
+    }
+
+    sign_batch_nonces(r, k_inverse, ok, count, curve);
+    for (i = 0; i < count; ++i) {
+        if (ok[i] && claimed) {
+            position = pool_claim(&pool->head, pool->sequence, uECC_NONCE_POOL_SIZE, 1,
+                                  &claimed);
+            if (claimed) {
+                nonce = (uECC_word_t *)pool->nonces[position % uECC_NONCE_POOL_SIZE];
+                uECC_vli_set(nonce, r[i], curve->num_words);
+                uECC_vli_set(nonce + POOL_NONCE_WORDS / 2, k_inverse[i], num_n_words);
+                pool_store(&pool->sequence[position % uECC_NONCE_POOL_SIZE], position + 1);
+                ++added;
+            }
         }
+        pool_wipe(k_inverse[i], sizeof(k_inverse[i]));
+    }
+    return added;
+}
 
-        if (uECC_sign_with_k_internal(private_key, message_hash, hash_size, k, signature, curve)) {
-            return 1;
+int uECC_sign_from_pool(uECC_NoncePool *pool,
+                        const uint8_t *private_key,
+                        const uint8_t *message_hash,
+                        unsigned hash_size,
+                        uint8_t *signature) {
+    uECC_word_t r[uECC_MAX_WORDS];
+    uECC_word_t k_inverse[uECC_MAX_WORDS];
+    uECC_word_t d[uECC_MAX_WORDS];
+    uECC_Curve curve = pool->curve;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    uECC_word_t *nonce;
+    unsigned position;
+    int claimed;
+    int signed_ok = 0;
+
+    load_private_key(d, private_key, curve);
+    while (!signed_ok) {
+        position = pool_claim(&pool->tail, pool->sequence, uECC_NONCE_POOL_SIZE, 0, &claimed);
+        if (!claimed) {
+            break;
         }
+        nonce = (uECC_word_t *)pool->nonces[position % uECC_NONCE_POOL_SIZE];
+        uECC_vli_set(r, nonce, curve->num_words);
+        uECC_vli_set(k_inverse, nonce + POOL_NONCE_WORDS / 2, num_n_words);
+        pool_wipe(nonce, sizeof(pool->nonces[0]));
+        pool_store(&pool->sequence[position % uECC_NONCE_POOL_SIZE],
+                   position + uECC_NONCE_POOL_SIZE);
+
+        /* s is out of range with negligible probability; the next nonce is then used. */
+        signed_ok = sign_with_nonce(signature, r, k_inverse, d, message_hash, hash_size, curve);
+        pool_wipe(k_inverse, sizeof(k_inverse));
     }
-    return 0;
+    pool_wipe(d, sizeof(d));
+    return signed_ok || uECC_sign(private_key, message_hash, hash_size, signature, curve);
 }
 
+#endif /* uECC_NONCE_POOL_SIZE */
+
 /* Compute an HMAC using K as a key (as in RFC 6979). Note that K is always
    the same size as the hash result size. */
 static void HMAC_init(const uECC_HashContext *hash_context, const uint8_t *K) {
@@ -1485,37 +4092,45 @@ int uECC_sign_deterministic(const uint8_t *private_key,
     return 0;
 }
 
-static bitcount_t smax(bitcount_t a, bitcount_t b) {
-    return (a > b ? a : b);
-}
-
-int uECC_verify(const uint8_t *public_key,
-                const uint8_t *message_hash,
-                unsigned hash_size,
-                const uint8_t *signature,
-                uECC_Curve curve) {
+/* Verifies an ECDSA signature with the public key Q. If q_table is not 0, it holds the
+   2^(q_window - 2) odd multiples of Q in affine coordinates (starting with Q itself); otherwise
+   they are computed from point. */
+static int ecdsa_verify(const uECC_word_t *point,
+                        const uECC_word_t *q_table,
+                        bitcount_t q_window,
+                        const uint8_t *message_hash,
+                        unsigned hash_size,
+                        const uint8_t *signature,
+                        uECC_Curve curve) {
     uECC_word_t u1[uECC_MAX_WORDS], u2[uECC_MAX_WORDS];
     uECC_word_t z[uECC_MAX_WORDS];
-    uECC_word_t sum[uECC_MAX_WORDS * 2];
     uECC_word_t rx[uECC_MAX_WORDS];
     uECC_word_t ry[uECC_MAX_WORDS];
-    uECC_word_t tx[uECC_MAX_WORDS];
-    uECC_word_t ty[uECC_MAX_WORDS];
-    uECC_word_t tz[uECC_MAX_WORDS];
-    const uECC_word_t *points[4];
-    const uECC_word_t *point;
-    bitcount_t num_bits;
-    bitcount_t i;
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    uECC_word_t *_public = (uECC_word_t *)public_key;
+    uECC_word_t local_q_table[WNAF_TABLE_SIZE(Q_WNAF_WINDOW) * uECC_MAX_WORDS * 2];
+#if uECC_G_WNAF_WINDOW
+    const uECC_word_t *g_table = curve->G_wnaf;
 #else
-    uECC_word_t _public[uECC_MAX_WORDS * 2];
+    uECC_word_t g_table[WNAF_TABLE_SIZE(G_WNAF_WINDOW) * uECC_MAX_WORDS * 2];
 #endif
+#if uECC_GLV_secp256k1
+    uECC_word_t lambda_g_table[WNAF_TABLE_SIZE(G_WNAF_WINDOW) * num_words_secp256k1 * 2];
+    uECC_word_t lambda_q_table[WNAF_TABLE_SIZE(WNAF_MAX_WINDOW) * num_words_secp256k1 * 2];
+    uECC_word_t halves[4][num_words_secp256k1];
+    uECC_word_t neg[4];
+    int8_t naf[4][uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+#else
+    int8_t naf[2][uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+#endif
+    const uECC_word_t *tables[4];
+    wordcount_t num_terms = 2;
+    bitcount_t num_bits = curve->num_n_bits;
+    uECC_word_t is_infinity = 1;
+    bitcount_t i;
+    wordcount_t j;
     uECC_word_t r[uECC_MAX_WORDS], s[uECC_MAX_WORDS];
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
 
-    rx[num_n_words - 1] = 0;
     r[num_n_words - 1] = 0;
     s[num_n_words - 1] = 0;
 
@@ -1523,9 +4138,6 @@ int uECC_verify(const uint8_t *public_key,
     bcopy((uint8_t *) r, signature, curve->num_bytes);
     bcopy((uint8_t *) s, signature + curve->num_bytes, curve->num_bytes);
 #else
-    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
-    uECC_vli_bytesToNative(
-        _public + num_words, public_key + curve->num_bytes, curve->num_bytes);
     uECC_vli_bytesToNative(r, signature, curve->num_bytes);
     uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
 #endif
@@ -1545,61 +4157,577 @@ int uECC_verify(const uint8_t *public_key,
     uECC_vli_modInv(z, s, curve->n, num_n_words); /* z = 1/s */
     u1[num_n_words - 1] = 0;
     bits2int(u1, message_hash, hash_size, curve);
-    uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
-    uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
-
-    /* Calculate sum = G + Q. */
-    uECC_vli_set(sum, _public, num_words);
-    uECC_vli_set(sum + num_words, _public + num_words, num_words);
-    uECC_vli_set(tx, curve->G, num_words);
-    uECC_vli_set(ty, curve->G + num_words, num_words);
-    uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
-    /* Note: safe to use tx for 'sub' param, since tx is not used after XYcZ_add. */
-    XYcZ_add(tx, ty, sum, sum + num_words, tx, curve);
-    uECC_vli_modInv(z, z, curve->p, num_words); /* z = 1/z */
-    apply_z(sum, sum + num_words, z, curve);
-
-    /* Use Shamir's trick to calculate u1*G + u2*Q */
-    points[0] = 0;
-    points[1] = curve->G;
-    points[2] = _public;
-    points[3] = sum;
-    num_bits = smax(uECC_vli_numBits(u1, num_n_words),
-                    uECC_vli_numBits(u2, num_n_words));
-
-    point = points[(!!uECC_vli_testBit(u1, num_bits - 1)) |
-                   ((!!uECC_vli_testBit(u2, num_bits - 1)) << 1)];
-    uECC_vli_set(rx, point, num_words);
-    uECC_vli_set(ry, point + num_words, num_words);
-    uECC_vli_clear(z, num_words);
-    z[0] = 1;
+    vli_modMult_n(u1, u1, z, curve); /* u1 = e/s */
+    vli_modMult_n(u2, r, z, curve);  /* u2 = r/s */
 
-    for (i = num_bits - 2; i >= 0; --i) {
-        uECC_word_t index;
-        curve->double_jacobian(rx, ry, z, curve);
+    /* Precompute the odd multiples of G and Q, and the non-adjacent forms of u1 and u2. */
+#if !uECC_G_WNAF_WINDOW
+    wnaf_table(g_table, curve->G, WNAF_TABLE_SIZE(G_WNAF_WINDOW), curve);
+#endif
+    if (!q_table) {
+        wnaf_table(local_q_table, point, WNAF_TABLE_SIZE(Q_WNAF_WINDOW), curve);
+        q_table = local_q_table;
+        q_window = Q_WNAF_WINDOW;
+    }
+    tables[0] = g_table;
+#if uECC_GLV_secp256k1
+    if (curve == &curve_secp256k1) {
+        /* u1*G + u2*Q = a1*G + a2*(lambda*G) + b1*Q + b2*(lambda*Q), with 128-bit halves. */
+        split_scalar_secp256k1(halves[0], halves[1], neg, u1);
+        split_scalar_secp256k1(halves[2], halves[3], neg + 2, u2);
+        endomorphism_secp256k1(lambda_g_table, g_table, WNAF_TABLE_SIZE(G_WNAF_WINDOW));
+        endomorphism_secp256k1(lambda_q_table, q_table, WNAF_TABLE_SIZE(q_window));
+        tables[1] = lambda_g_table;
+        tables[2] = q_table;
+        tables[3] = lambda_q_table;
+        num_terms = 4;
+        num_bits = GLV_BITS;
+        for (j = 0; j < num_terms; ++j) {
+            vli_wnaf(naf[j], halves[j], num_bits, (j < 2) ? G_WNAF_WINDOW : q_window);
+            for (i = 0; i <= num_bits; ++i) {
+                naf[j][i] = neg[j] ? -naf[j][i] : naf[j][i];
+            }
+        }
+    } else
+#endif
+    {
+        tables[1] = q_table;
+        vli_wnaf(naf[0], u1, num_bits, G_WNAF_WINDOW);
+        vli_wnaf(naf[1], u2, num_bits, q_window);
+    }
 
-        index = (!!uECC_vli_testBit(u1, i)) | ((!!uECC_vli_testBit(u2, i)) << 1);
-        point = points[index];
-        if (point) {
-            uECC_vli_set(tx, point, num_words);
-            uECC_vli_set(ty, point + num_words, num_words);
-            apply_z(tx, ty, z, curve);
-            uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
-            XYcZ_add(tx, ty, rx, ry, tx, curve);
-            uECC_vli_modMult_fast(z, z, tz, curve);
+    /* Calculate u1*G + u2*Q, interleaving the non-adjacent forms. */
+    for (i = num_bits; i >= 0; --i) {
+        if (!is_infinity) {
+            curve->double_jacobian(rx, ry, z, curve);
+        }
+        for (j = 0; j < num_terms; ++j) {
+            if (naf[j][i]) {
+                add_wnaf_entry(rx, ry, z, &is_infinity, tables[j], naf[j][i], curve);
+            }
         }
     }
+    if (is_infinity) {
+        return 0;
+    }
 
-    uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
-    apply_z(rx, ry, z, curve);
+    /* Accept only if v = x1 (mod n) == r. Since x1 < p, that means x1 == r, or x1 == r + n
+       when r + n < p. x1 = X / Z^2, so compare r * Z^2 with X instead of inverting Z. */
+    if (uECC_vli_cmp_unsafe(curve->p, r, num_n_words) != 1) {
+        return 0;
+    }
+    uECC_vli_modSquare_fast(z, z, curve);    /* z = Z^2 */
+    uECC_vli_modMult_fast(s, r, z, curve);   /* s = r * Z^2 */
+    if (uECC_vli_equal(s, rx, num_words)) {
+        return 1;
+    }
+    if (uECC_vli_cmp_unsafe(curve->p, curve->n, num_n_words) == 1 &&
+            !uECC_vli_add(s, r, curve->n, num_words) &&
+            uECC_vli_cmp_unsafe(curve->p, s, num_words) == 1) {
+        uECC_vli_modMult_fast(s, s, z, curve); /* s = (r + n) * Z^2 */
+        return (int)(uECC_vli_equal(s, rx, num_words));
+    }
+    return 0;
+}
+
+int uECC_verify(const uint8_t *public_key,
+                const uint8_t *message_hash,
+                unsigned hash_size,
+                const uint8_t *signature,
+                uECC_Curve curve) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_word_t *_public = (uECC_word_t *)public_key;
+#else
+    uECC_word_t _public[uECC_MAX_WORDS * 2];
+
+    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(
+        _public + curve->num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+    return ecdsa_verify(_public, 0, 0, message_hash, hash_size, signature, curve);
+}
+
+int uECC_prepare_key(const uint8_t *public_key, uECC_PreparedKey *prepared, uECC_Curve curve) {
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_word_t *_public = (uECC_word_t *)public_key;
+#else
+    uECC_word_t _public[uECC_MAX_WORDS * 2];
+
+    uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(
+        _public + curve->num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+
+    if (!uECC_valid_point(_public, curve)) {
+        return 0;
+    }
+    prepared->curve = curve;
+    wnaf_table((uECC_word_t *)prepared->table, _public,
+               WNAF_TABLE_SIZE(uECC_PREPARED_WINDOW), curve);
+    return 1;
+}
 
-    /* v = x1 (mod n) */
-    if (uECC_vli_cmp_unsafe(curve->n, rx, num_n_words) != 1) {
-        uECC_vli_sub(rx, rx, curve->n, num_n_words);
+int uECC_verify_prepared(const uECC_PreparedKey *prepared,
+                         const uint8_t *message_hash,
+                         unsigned hash_size,
+                         const uint8_t *signature) {
+    const uECC_word_t *q_table = (const uECC_word_t *)prepared->table;
+    return ecdsa_verify(q_table, q_table, uECC_PREPARED_WINDOW, message_hash, hash_size,
+                        signature, prepared->curve);
+}
+
+/* The arguments of a uECC_verify_batch() call, for verify_batch_part(). */
+typedef struct verify_batch_args_t {
+    const uint8_t *public_keys;
+    const uint8_t *message_hashes;
+    unsigned hash_size;
+    const uint8_t *signatures;
+    const uint8_t *recovery_ids;
+    uECC_Curve curve;
+} verify_batch_args_t;
+
+#if VERIFY_BATCH
+
+/* Loads the public key and signature of one entry of uECC_verify_batch() into q (the public key),
+   r_point (-R, recovered from r using the recovery id), r and s, and the 16 random bytes of weight
+   into a. Returns 0 if the entry cannot go in the combined check: it has no usable recovery id or
+   no weight, or the public key or signature is not valid (r_point is then not set, but q is). */
+static int verify_batch_load(uECC_word_t *q,
+                             uECC_word_t *r_point,
+                             uECC_word_t *r,
+                             uECC_word_t *s,
+                             uECC_word_t *a,
+                             const uint8_t *public_key,
+                             const uint8_t *signature,
+                             const uint8_t *recovery_id,
+                             const uint8_t *weight,
+                             uECC_Curve curve) {
+    uECC_word_t v[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    uECC_word_t *y = r_point + curve->num_words;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned i;
+
+    r[num_n_words - 1] = 0;
+    s[num_n_words - 1] = 0;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_vli_set(q, (const uECC_word_t *)public_key, num_words * 2);
+    bcopy((uint8_t *) r, signature, curve->num_bytes);
+    bcopy((uint8_t *) s, signature + curve->num_bytes, curve->num_bytes);
+#else
+    uECC_vli_bytesToNative(q, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(q + num_words, public_key + curve->num_bytes, curve->num_bytes);
+    uECC_vli_bytesToNative(r, signature, curve->num_bytes);
+    uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
+#endif
+
+    if (!recovery_id || (*recovery_id & 2) || !weight) {
+        return 0;
+    }
+    if (uECC_vli_isZero(r, num_n_words) || uECC_vli_isZero(s, num_n_words) ||
+            uECC_vli_cmp_unsafe(curve->n, r, num_n_words) != 1 ||
+            uECC_vli_cmp_unsafe(curve->n, s, num_n_words) != 1 ||
+            uECC_vli_cmp_unsafe(curve->p, r, num_words) != 1 ||
+            !uECC_valid_point(q, curve)) {
+        return 0;
+    }
+
+    /* R = (r, y), where y^2 = r^3 + ar + b and bit 0 of the recovery id is the parity of y. */
+    uECC_vli_set(r_point, r, num_words);
+    curve->x_side(v, r_point, curve);
+    uECC_vli_set(y, v, num_words);
+    curve->mod_sqrt(y, curve);
+    uECC_vli_modSquare_fast(t, y, curve);
+    if (!uECC_vli_equal(t, v, num_words)) {
+        return 0;
+    }
+    if ((y[0] & 1) == (*recovery_id & 1)) {
+        uECC_vli_sub(y, curve->p, y, num_words);
+    }
+
+    uECC_vli_clear(a, num_n_words);
+    for (i = 0; i < 16; ++i) {
+        ((uint8_t *)a)[i] = weight[i];
+    }
+    a[0] |= 1;
+    return 1;
+}
+
+/* Returns 1 if the combined verification equation of entries lo to hi - 1 of
+   verify_batch_part() holds, that is, if the sum of g_terms[j] * G + scalars[2j + 1] * Q_j +
+   scalars[2j + 2] * (-R_j) over those entries is the point at infinity. Slot 2 * lo of points
+   and scalars (which is spare for lo = 0, and holds -R of entry lo - 1 otherwise) is used for
+   G during the call. */
+static int verify_batch_check(uECC_word_t *points,
+                              uECC_word_t *scalars,
+                              const uECC_word_t *g_terms,
+                              unsigned lo,
+                              unsigned hi,
+                              uECC_Curve curve) {
+    uECC_word_t saved_point[uECC_MAX_WORDS * 2];
+    uECC_word_t saved_scalar[uECC_MAX_WORDS];
+    uECC_word_t result[uECC_MAX_WORDS * 2];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    uECC_word_t *point = points + 2 * lo * num_words * 2;
+    uECC_word_t *scalar = scalars + 2 * lo * num_n_words;
+    int valid;
+    unsigned j;
+
+    uECC_vli_set(saved_point, point, num_words * 2);
+    uECC_vli_set(saved_scalar, scalar, num_n_words);
+    uECC_vli_set(point, curve->G, num_words * 2);
+    uECC_vli_clear(scalar, num_n_words);
+    for (j = lo; j < hi; ++j) {
+        uECC_vli_modAdd(scalar, scalar, g_terms + j * uECC_MAX_WORDS, curve->n, num_n_words);
+    }
+
+    valid = !EccPoint_multi_mult(result, point, scalar, 2 * (hi - lo) + 1, curve);
+
+    uECC_vli_set(point, saved_point, num_words * 2);
+    uECC_vli_set(scalar, saved_scalar, num_n_words);
+    return valid;
+}
+
+/* Verifies signatures start to start + count - 1 of a uECC_verify_batch() call, for
+   count <= uECC_VERIFY_BATCH_SIZE (a batch_part_t). With a random weight a
+   for each signature, u1 = e / s and u2 = r / s, it checks that
+   sum(a * u1) * G + sum(a * u2 * Q) - sum(a * R) is the point at infinity, which holds if all
+   the signatures are valid, and only holds with probability about 2^-127 otherwise. If the check
+   fails, each half is checked in the same way, down to single signatures, which are checked with
+   uECC_verify() (so a wrong recovery id does not change the result). */
+static int verify_batch_part(const void *args,
+                             unsigned start,
+                             unsigned count,
+                             uint8_t *results) {
+    /* Entry j of the combined check uses slots 2j + 1 (Q, with scalar a * u2) and 2j + 2 (-R,
+       with scalar a); slot 0 is for verify_batch_check(). */
+    uECC_word_t points[(2 * uECC_VERIFY_BATCH_SIZE + 1) * uECC_MAX_WORDS * 2];
+    uECC_word_t scalars[(2 * uECC_VERIFY_BATCH_SIZE + 1) * uECC_MAX_WORDS];
+    uECC_word_t g_terms[uECC_VERIFY_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t inverses[uECC_VERIFY_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t products[uECC_VERIFY_BATCH_SIZE][uECC_MAX_WORDS];
+    uint8_t weights[uECC_VERIFY_BATCH_SIZE * 16];
+    uint8_t index[uECC_VERIFY_BATCH_SIZE];
+    unsigned range_lo[16];
+    unsigned range_hi[16];
+    const verify_batch_args_t *batch = (const verify_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned hash_size = batch->hash_size;
+    unsigned signature_size = curve->num_bytes * 2;
+    const uint8_t *public_keys = batch->public_keys + start * signature_size;
+    const uint8_t *message_hashes = batch->message_hashes + start * hash_size;
+    const uint8_t *signatures = batch->signatures + start * signature_size;
+    const uint8_t *recovery_ids = (batch->recovery_ids ? batch->recovery_ids + start : 0);
+    uECC_word_t *q;
+    uECC_word_t *u2;
+    uECC_word_t *a;
+    unsigned num_entries = 0;
+    unsigned top;
+    unsigned lo, hi;
+    unsigned i, j;
+    int all_valid = 1;
+    int valid;
+    int have_weights = (recovery_ids && g_rng_function && g_rng_function(weights, count * 16));
+
+    for (i = 0; i < count; ++i) {
+        j = num_entries;
+        q = points + (2 * j + 1) * num_words * 2;
+        u2 = scalars + (2 * j + 1) * num_n_words;
+        a = u2 + num_n_words;
+        if (verify_batch_load(q, q + num_words * 2, u2, inverses[j], a,
+                              public_keys + i * signature_size, signatures + i * signature_size,
+                              recovery_ids ? recovery_ids + i : 0,
+                              have_weights ? weights + i * 16 : 0, curve)) {
+            index[num_entries++] = (uint8_t)i;
+            continue;
+        }
+        valid = ecdsa_verify(q, 0, 0, message_hashes + i * hash_size, hash_size,
+                             signatures + i * signature_size, curve);
+        if (results) {
+            results[i] = (uint8_t)valid;
+        }
+        all_valid &= valid;
+    }
+    if (!num_entries) {
+        return all_valid;
+    }
+
+    /* u1 = e / s and u2 = r / s, with one inversion for all the entries. */
+    batch_mod_inv(inverses[0], num_entries, products[0], 1, curve);
+    for (j = 0; j < num_entries; ++j) {
+        u2 = scalars + (2 * j + 1) * num_n_words;
+        a = u2 + num_n_words;
+        g_terms[j][num_n_words - 1] = 0;
+        bits2int(g_terms[j], message_hashes + index[j] * hash_size, hash_size, curve);
+        vli_modMult_n(g_terms[j], g_terms[j], inverses[j], curve);
+        vli_modMult_n(g_terms[j], g_terms[j], a, curve);   /* a * u1 */
+        vli_modMult_n(u2, u2, inverses[j], curve);
+        vli_modMult_n(u2, u2, a, curve);                   /* a * u2 */
+    }
+
+    range_lo[0] = 0;
+    range_hi[0] = num_entries;
+    top = 1;
+    while (top) {
+        --top;
+        lo = range_lo[top];
+        hi = range_hi[top];
+        if (verify_batch_check(points, scalars, g_terms[0], lo, hi, curve)) {
+            for (j = lo; results && j < hi; ++j) {
+                results[index[j]] = 1;
+            }
+        } else if (hi - lo == 1) {
+            i = index[lo];
+            valid = ecdsa_verify(points + (2 * lo + 1) * num_words * 2, 0, 0,
+                                 message_hashes + i * hash_size, hash_size,
+                                 signatures + i * signature_size, curve);
+            if (results) {
+                results[i] = (uint8_t)valid;
+            }
+            all_valid &= valid;
+        } else {
+            /* Check the first half next; the stack holds at most one range per halving. */
+            range_lo[top] = (lo + hi) / 2;
+            range_hi[top] = hi;
+            range_lo[top + 1] = lo;
+            range_hi[top + 1] = (lo + hi) / 2;
+            top += 2;
+        }
+    }
+    return all_valid;
+}
+
+#else /* !VERIFY_BATCH */
+
+/* Verifies signatures start to start + count - 1 of a uECC_verify_batch() call one at a time
+   (a batch_part_t). */
+static int verify_batch_part(const void *args,
+                             unsigned start,
+                             unsigned count,
+                             uint8_t *results) {
+    const verify_batch_args_t *batch = (const verify_batch_args_t *)args;
+    unsigned signature_size = batch->curve->num_bytes * 2;
+    unsigned i;
+    int all_valid = 1;
+    int valid;
+
+    for (i = start; i < start + count; ++i) {
+        valid = uECC_verify(batch->public_keys + i * signature_size,
+                            batch->message_hashes + i * batch->hash_size, batch->hash_size,
+                            batch->signatures + i * signature_size, batch->curve);
+        if (results) {
+            results[i - start] = (uint8_t)valid;
+        }
+        all_valid &= valid;
+    }
+    return all_valid;
+}
+
+#endif /* VERIFY_BATCH */
+
+int uECC_verify_batch(const uint8_t *public_keys,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      const uint8_t *recovery_ids,
+                      unsigned count,
+                      uint8_t *results,
+                      uECC_Curve curve) {
+    verify_batch_args_t args;
+
+    args.public_keys = public_keys;
+    args.message_hashes = message_hashes;
+    args.hash_size = hash_size;
+    args.signatures = signatures;
+    args.recovery_ids = recovery_ids;
+    args.curve = curve;
+#if VERIFY_BATCH
+    return run_batch(&verify_batch_part, &args, count, uECC_VERIFY_BATCH_SIZE, results);
+#else
+    return run_batch(&verify_batch_part, &args, count, BATCH_MAX_PART, results);
+#endif
+}
+
+int uECC_shared_secret_prepared(const uECC_PreparedKey *prepared,
+                                const uint8_t *private_key,
+                                uint8_t *secret) {
+    uECC_word_t _public[uECC_MAX_WORDS * 2];
+    uECC_word_t _private[uECC_MAX_WORDS];
+    uECC_word_t tmp[uECC_MAX_WORDS];
+    uECC_word_t *initial_Z = 0;
+    uECC_Curve curve = prepared->curve;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_bytes = curve->num_bytes;
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_vli_clear(_private, BITS_TO_WORDS(curve->num_n_bits));
+    bcopy((uint8_t *) _private, private_key, BITS_TO_BYTES(curve->num_n_bits));
+#else
+    uECC_vli_bytesToNative(_private, private_key, BITS_TO_BYTES(curve->num_n_bits));
+#endif
+
+    /* If an RNG function was specified, try to get a random initial Z value to improve
+       protection against side-channel attacks. */
+    if (g_rng_function) {
+        if (!uECC_generate_random_int(tmp, curve->p, num_words)) {
+            return 0;
+        }
+        initial_Z = tmp;
+    }
+
+    /* The table of a prepared key is used as a signed window one bit narrower than its
+       non-adjacent form. */
+    uECC_vli_set(_public, (const uECC_word_t *)prepared->table, num_words * 2);
+    EccPoint_mult_secret(_public, (const uECC_word_t *)prepared->table,
+                         uECC_PREPARED_WINDOW - 1, _private, initial_Z, 0, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) secret, (uint8_t *) _public, num_bytes);
+#else
+    uECC_vli_nativeToBytes(secret, num_bytes, _public);
+#endif
+    return !EccPoint_isZero(_public, curve);
+}
+
+/* The arguments of a uECC_shared_secret_batch() call, for shared_secret_batch_part(). */
+typedef struct shared_secret_batch_args_t {
+    const uint8_t *public_keys;
+    const uint8_t *private_key;
+#if uECC_SHARED_SECRET_BATCH_SIZE
+    uECC_word_t d[uECC_MAX_WORDS]; /* decoded by load_private_key() */
+#endif
+    uint8_t *secrets;
+    uECC_Curve curve;
+} shared_secret_batch_args_t;
+
+#if uECC_SHARED_SECRET_BATCH_SIZE
+
+/* Computes shared secrets start to start + count - 1 of a uECC_shared_secret_batch() call, for
+   count <= uECC_SHARED_SECRET_BATCH_SIZE (a batch_part_t). The valid public keys go through
+   EccPoint_mult_batch() together, with initial Z values drawn by one call to the RNG function;
+   the secrets of invalid public keys are left unchanged. */
+static int shared_secret_batch_part(const void *args,
+                                    unsigned start,
+                                    unsigned count,
+                                    uint8_t *results) {
+    uECC_word_t points[uECC_SHARED_SECRET_BATCH_SIZE * uECC_MAX_WORDS * 2];
+    uECC_word_t scalars[uECC_SHARED_SECRET_BATCH_SIZE * uECC_MAX_WORDS];
+    uECC_word_t initial_Z[uECC_SHARED_SECRET_BATCH_SIZE][uECC_MAX_WORDS];
+    uint8_t index[uECC_SHARED_SECRET_BATCH_SIZE];
+    const shared_secret_batch_args_t *batch = (const shared_secret_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_bytes = curve->num_bytes;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    const uint8_t *public_key;
+    uint8_t *secret;
+    uECC_word_t *point;
+    unsigned num_valid = 0;
+    unsigned i;
+    int ok;
+    int all_ok = 1;
+
+    for (i = 0; i < count; ++i) {
+        if (results) {
+            results[i] = 0;
+        }
+    }
+    /* If an RNG function was specified, get random initial Z values to improve protection
+       against side-channel attacks, as in uECC_shared_secret(). */
+    if (g_rng_function &&
+            (!g_rng_function((uint8_t *)initial_Z[0], count * uECC_MAX_WORDS * uECC_WORD_SIZE) ||
+             !random_ints_in_range(initial_Z[0], count, curve->p, num_words))) {
+        return 0;
+    }
+
+    for (i = 0; i < count; ++i) {
+        public_key = batch->public_keys + (start + i) * num_bytes * 2;
+        point = points + num_valid * num_words * 2;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        uECC_vli_clear(point, num_words * 2);
+        bcopy((uint8_t *) point, public_key, num_bytes * 2);
+#else
+        uECC_vli_bytesToNative(point, public_key, num_bytes);
+        uECC_vli_bytesToNative(point + num_words, public_key + num_bytes, num_bytes);
+#endif
+        if (uECC_valid_point(point, curve)) {
+            uECC_vli_set(scalars + num_valid * num_n_words, batch->d, num_n_words);
+            index[num_valid++] = (uint8_t)i;
+        }
+    }
+    if (num_valid) {
+        EccPoint_mult_batch(points, points, scalars, g_rng_function ? initial_Z[0] : 0,
+                            num_valid, curve);
+    }
+    for (i = 0; i < num_valid; ++i) {
+        point = points + i * num_words * 2;
+        secret = batch->secrets + (start + index[i]) * num_bytes;
+        ok = !EccPoint_isZero(point, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+        bcopy(secret, (uint8_t *) point, num_bytes);
+#else
+        uECC_vli_nativeToBytes(secret, num_bytes, point);
+#endif
+        if (results) {
+            results[index[i]] = (uint8_t)ok;
+        }
+        all_ok &= ok;
+    }
+    return all_ok && num_valid == count;
+}
+
+#else /* !uECC_SHARED_SECRET_BATCH_SIZE */
+
+/* Computes shared secrets start to start + count - 1 of a uECC_shared_secret_batch() call one
+   at a time (a batch_part_t). */
+static int shared_secret_batch_part(const void *args,
+                                    unsigned start,
+                                    unsigned count,
+                                    uint8_t *results) {
+    const shared_secret_batch_args_t *batch = (const shared_secret_batch_args_t *)args;
+    uECC_Curve curve = batch->curve;
+    const uint8_t *public_key;
+    unsigned i;
+    int all_ok = 1;
+    int ok;
+
+    for (i = start; i < start + count; ++i) {
+        public_key = batch->public_keys + i * curve->num_bytes * 2;
+        ok = (uECC_valid_public_key(public_key, curve) &&
+              uECC_shared_secret(public_key, batch->private_key,
+                                 batch->secrets + i * curve->num_bytes, curve));
+        if (results) {
+            results[i - start] = (uint8_t)ok;
+        }
+        all_ok &= ok;
     }
+    return all_ok;
+}
 
-    /* Accept only if v == r. */
-    return (int)(uECC_vli_equal(rx, r, num_words));
+#endif /* uECC_SHARED_SECRET_BATCH_SIZE */
+
+int uECC_shared_secret_batch(const uint8_t *public_keys,
+                             const uint8_t *private_key,
+                             unsigned count,
+                             uint8_t *secrets,
+                             uint8_t *results,
+                             uECC_Curve curve) {
+    shared_secret_batch_args_t args;
+
+    args.public_keys = public_keys;
+    args.private_key = private_key;
+    args.secrets = secrets;
+    args.curve = curve;
+#if uECC_SHARED_SECRET_BATCH_SIZE
+    load_private_key(args.d, private_key, curve);
+    return run_batch(&shared_secret_batch_part, &args, count, uECC_SHARED_SECRET_BATCH_SIZE,
+                     results);
+#else
+    return run_batch(&shared_secret_batch_part, &args, count, BATCH_MAX_PART, results);
+#endif
 }
 
 #if uECC_ENABLE_VLI_API
@@ -1662,12 +4790,24 @@ void uECC_point_mult(uECC_word_t *result,
                      const uECC_word_t *point,
                      const uECC_word_t *scalar,
                      uECC_Curve curve) {
-    uECC_word_t tmp1[uECC_MAX_WORDS];
-    uECC_word_t tmp2[uECC_MAX_WORDS];
-    uECC_word_t *p2[2] = {tmp1, tmp2};
-    uECC_word_t carry = regularize_k(scalar, tmp1, tmp2, curve);
+    uECC_vli_set(result, point, curve->num_words * 2);
+    EccPoint_mult_secret(result, 0, 0, scalar, 0, 0, curve);
+}
+
+int uECC_point_multi_mult(uECC_word_t *result,
+                          const uECC_word_t *points,
+                          const uECC_word_t *scalars,
+                          unsigned count,
+                          uECC_Curve curve) {
+    return (int)EccPoint_multi_mult(result, points, scalars, count, curve);
+}
 
-    EccPoint_mult(result, point, p2[!carry], 0, curve->num_n_bits + 1, curve);
+void uECC_point_mult_batch(uECC_word_t *results,
+                           const uECC_word_t *points,
+                           const uECC_word_t *scalars,
+                           unsigned count,
+                           uECC_Curve curve) {
+    EccPoint_mult_batch(results, points, scalars, 0, count, curve);
 }
 
 #endif /* uECC_ENABLE_VLI_API */
@@ -52,6 +52,189 @@ the same endianness. */
     #define uECC_VLI_NATIVE_LITTLE_ENDIAN 0
 #endif
 
+/* uECC_LAZY_REDUCTION - If enabled (defined as nonzero), the point addition and doubling
+formulas skip the final comparison against p after additions whose result is only used as a
+multiplication input. Intermediate values are then kept below 2^N rather than below p. */
+#ifndef uECC_LAZY_REDUCTION
+    #define uECC_LAZY_REDUCTION 1
+#endif
+
+/* uECC_SAFEGCD_INVERSE - If enabled (defined as nonzero), modular inversion will use the
+constant-time "safegcd" algorithm (Bernstein-Yang divsteps, in batches of 62 bits on 64-bit
+platforms and 30 bits on 32-bit platforms) instead of the binary extended Euclidean algorithm.
+This is faster, and lets signing skip the random blinding around the inversion of k.
+This has no effect when uECC_WORD_SIZE is 1. With GCC -Os for a 32-bit target, costs about 0.8 kB
+of code and 120 bytes of stack. */
+#ifndef uECC_SAFEGCD_INVERSE
+    #define uECC_SAFEGCD_INVERSE 1
+#endif
+
+/* uECC_FAST_DEFAULTS - Default for the options below, which trade code size and stack space for
+speed. Defaults to 1 on 64-bit x86 and ARM targets and to 0 elsewhere, so that builds for
+microcontrollers stay small unless the options are enabled one at a time. The costs given for
+each option were measured with GCC -Os for a 32-bit target with only secp256r1 enabled; they are
+in addition to a build with all of these options off. */
+#ifndef uECC_FAST_DEFAULTS
+    #if defined(__x86_64__) || defined(__amd64__) || defined(_M_X64) || \
+        defined(__aarch64__) || defined(_M_ARM64)
+        #define uECC_FAST_DEFAULTS 1
+    #else
+        #define uECC_FAST_DEFAULTS 0
+    #endif
+#endif
+
+/* uECC_G_COMB_TEETH - Number of teeth in the fixed-base comb used for multiplications by the
+generator G (in uECC_make_key(), uECC_compute_public_key() and the signing functions). Each
+enabled curve gets a constant table of 2^(uECC_G_COMB_TEETH - 1) points; supported values are
+2 - 6, where more teeth give faster key generation and signing but larger tables (2 kB for
+secp256r1 with 6 teeth). Set to 0 to remove the tables and use the regular point multiplication.
+With 5 teeth, costs about 2 kB of code and constant data per curve (1 kB of it is the table) and
+130 bytes of stack. On AVR, the tables are stored in RAM.
+Defaults to 5 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_G_COMB_TEETH
+    #if uECC_FAST_DEFAULTS
+        #define uECC_G_COMB_TEETH 5
+    #else
+        #define uECC_G_COMB_TEETH 0
+    #endif
+#endif
+
+/* uECC_G_WNAF_WINDOW - Width of the non-adjacent form used for the multiple of G in
+uECC_verify(). Each enabled curve gets a constant table of 2^(uECC_G_WNAF_WINDOW - 2) odd
+multiples of G; supported values are 4 - 7. Set to 0 to remove the tables; the multiples of G
+are then computed on each verification, like those of the public key.
+With a width of 6, costs about 1 kB of constant data per curve, and saves 250 bytes of stack in
+uECC_verify(). On AVR, the tables are stored in RAM.
+Defaults to 6 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_G_WNAF_WINDOW
+    #if uECC_FAST_DEFAULTS
+        #define uECC_G_WNAF_WINDOW 6
+    #else
+        #define uECC_G_WNAF_WINDOW 0
+    #endif
+#endif
+
+/* uECC_GLV_ENDOMORPHISM - If enabled (defined as nonzero), scalar multiplications on secp256k1
+in uECC_verify() and uECC_shared_secret() will use the curve's efficiently computable
+endomorphism (Gallant-Lambert-Vanstone): each scalar is split into two halves of about 128 bits,
+which halves the number of point doublings. uECC_shared_secret() stays constant time.
+When secp256k1 is enabled, costs about 3 kB of code and 1.5 kB of stack in uECC_verify() (450
+bytes in uECC_shared_secret()). Defaults to uECC_FAST_DEFAULTS. */
+#ifndef uECC_GLV_ENDOMORPHISM
+    #define uECC_GLV_ENDOMORPHISM uECC_FAST_DEFAULTS
+#endif
+
+/* uECC_MULT_WINDOW - Width of the signed fixed window used to multiply an arbitrary point by a
+secret scalar (in uECC_shared_secret() and uECC_point_mult()). Each multiplication builds a
+table of 2^(uECC_MULT_WINDOW - 1) odd multiples of the point on the stack (1 kB for secp256r1
+with a width of 5), which is read in full for every window so that the result stays constant
+time; supported values are 2 - 6. Set to 0 to use the co-Z Montgomery ladder instead, which is
+slower but needs less stack space. With a width of 5, costs about 1.2 kB of stack in
+uECC_shared_secret() and no extra code.
+On secp256k1, uECC_GLV_ENDOMORPHISM takes precedence.
+Defaults to 5 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_MULT_WINDOW
+    #if uECC_FAST_DEFAULTS
+        #define uECC_MULT_WINDOW 5
+    #else
+        #define uECC_MULT_WINDOW 0
+    #endif
+#endif
+
+/* uECC_PREPARED_WINDOW - Width of the non-adjacent form used for the public key in
+uECC_verify_prepared(). A uECC_PreparedKey holds 2^(uECC_PREPARED_WINDOW - 2) odd multiples
+of the public key (1 kB for secp256r1 with a width of 6, 256 bytes with a width of 4), which
+uECC_shared_secret_prepared() uses as a signed window one bit narrower. Supported values are
+4 - 7. A width of 6 also costs about 400 bytes of stack in uECC_verify().
+Defaults to 6 if uECC_FAST_DEFAULTS is enabled, and to 4 otherwise. */
+#ifndef uECC_PREPARED_WINDOW
+    #if uECC_FAST_DEFAULTS
+        #define uECC_PREPARED_WINDOW 6
+    #else
+        #define uECC_PREPARED_WINDOW 4
+    #endif
+#endif
+
+/* uECC_VERIFY_BATCH_SIZE - Largest number of signatures that uECC_verify_batch() checks with a
+single multi-scalar multiplication; longer batches are split into parts of this size. The parts
+are kept on the stack, taking about 300 bytes per signature when secp256r1 or secp256k1 is
+enabled, on top of about 20 kB for the multi-scalar multiplication. Supported values are
+0 - 256. Set to 0 to have uECC_verify_batch() check each signature with uECC_verify(). Costs
+about 5 kB of code. Defaults to 64 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_VERIFY_BATCH_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_VERIFY_BATCH_SIZE 64
+    #else
+        #define uECC_VERIFY_BATCH_SIZE 0
+    #endif
+#endif
+
+/* uECC_SIGN_BATCH_SIZE - Largest number of signatures that uECC_sign_batch() computes with a
+single field inversion and a single inversion mod n; longer batches are split into parts of this
+size. The parts are kept on the stack, taking about 160 bytes per signature when secp256r1 or
+secp256k1 is enabled. Supported values are 0 - 256. Set to 0 to have uECC_sign_batch() call
+uECC_sign() for each signature. Costs about 2 kB of code. Defaults to 64 if uECC_FAST_DEFAULTS
+is enabled, and to 0 otherwise. */
+#ifndef uECC_SIGN_BATCH_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_SIGN_BATCH_SIZE 64
+    #else
+        #define uECC_SIGN_BATCH_SIZE 0
+    #endif
+#endif
+
+/* uECC_MAKE_KEY_BATCH_SIZE - Largest number of key pairs that uECC_make_key_batch() (and
+uECC_key_pool_refill()) computes with a single field inversion; longer batches are split into
+parts of this size. The parts are kept on the stack, taking about 160 bytes per key pair when
+secp256r1 or secp256k1 is enabled. Supported values are 0 - 256. Set to 0 to have
+uECC_make_key_batch() call uECC_make_key() for each key pair. Costs about 1.3 kB of code.
+Defaults to 32 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_MAKE_KEY_BATCH_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_MAKE_KEY_BATCH_SIZE 32
+    #else
+        #define uECC_MAKE_KEY_BATCH_SIZE 0
+    #endif
+#endif
+
+/* uECC_SHARED_SECRET_BATCH_SIZE - Largest number of shared secrets that uECC_shared_secret_batch()
+computes together; longer batches are split into parts of this size. The parts are kept on the
+stack, taking about 150 bytes per shared secret when secp256r1 or secp256k1 is enabled.
+Supported values are 0 - 256. Set to 0 to have uECC_shared_secret_batch() call
+uECC_shared_secret() for each public key. Costs about 1.9 kB of code. Defaults to 32 if
+uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_SHARED_SECRET_BATCH_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_SHARED_SECRET_BATCH_SIZE 32
+    #else
+        #define uECC_SHARED_SECRET_BATCH_SIZE 0
+    #endif
+#endif
+
+/* uECC_NONCE_POOL_SIZE - Number of signing nonces that a uECC_NoncePool can hold. A pool takes
+about 64 bytes per nonce when secp256r1 or secp256k1 is enabled. Supported values are powers of
+two up to 1024. Set to 0 to remove the nonce pool functions. Costs about 2.5 kB of code.
+Defaults to 64 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_NONCE_POOL_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_NONCE_POOL_SIZE 64
+    #else
+        #define uECC_NONCE_POOL_SIZE 0
+    #endif
+#endif
+
+/* uECC_KEY_POOL_SIZE - Number of key pairs that a uECC_KeyPool can hold. A pool takes about
+100 bytes per key pair when secp256r1 or secp256k1 is enabled. Supported values are powers of
+two up to 1024. Set to 0 to remove the key pool functions. Costs about 1.7 kB of code.
+Defaults to 16 if uECC_FAST_DEFAULTS is enabled, and to 0 otherwise. */
+#ifndef uECC_KEY_POOL_SIZE
+    #if uECC_FAST_DEFAULTS
+        #define uECC_KEY_POOL_SIZE 16
+    #else
+        #define uECC_KEY_POOL_SIZE 0
+    #endif
+#endif
+
 /* Curve support selection. Set to 0 to remove that curve. */
 #ifndef uECC_SUPPORTS_secp160r1
     #define uECC_SUPPORTS_secp160r1 1
@@ -78,6 +261,13 @@ the same endianness. */
 struct uECC_Curve_t;
 typedef const struct uECC_Curve_t * uECC_Curve;
 
+/* Largest size of a coordinate in memory, for the enabled curves. */
+#if uECC_SUPPORTS_secp224r1 || uECC_SUPPORTS_secp256r1 || uECC_SUPPORTS_secp256k1
+    #define uECC_MAX_COORDINATE_BYTES 32
+#else
+    #define uECC_MAX_COORDINATE_BYTES 24
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -135,6 +325,45 @@ Returns the function that will be used to generate random bytes.
 */
 uECC_RNG_Function uECC_get_rng(void);
 
+/* uECC_Job_Function type
+One job of a batch call, such as uECC_verify_batch(), as passed to a uECC_Executor function.
+Calling it with the index of the job runs that part of the batch call.
+*/
+typedef void (*uECC_Job_Function)(void *context, unsigned index);
+
+/* uECC_Executor type
+The executor function runs the jobs of a batch call on several threads. It must call
+job(context, i) exactly once for each i < count, in any order and from any threads, and return
+only after all of those calls have returned; for example, it can push the jobs to a
+work-stealing thread pool and wait for them to finish.
+
+The jobs do not share any writable memory: each keeps its scratch space on the stack of the
+thread that runs it, and writes its results to its own part of the output buffers. Note that the
+RNG function is then called from several threads at once, so it must be thread-safe (the
+predefined RNG functions are).
+*/
+typedef void (*uECC_Executor)(uECC_Job_Function job, void *context, unsigned count);
+
+/* uECC_set_executor() function.
+Set the function that batch calls use to run their jobs in parallel. By default, or after
+uECC_set_executor(0, 0), batch calls run on the calling thread.
+
+Inputs:
+    executor    - The executor function, or 0 to run batch calls on the calling thread.
+    num_threads - The number of threads that the executor runs jobs on. Each batch call is split
+                  into this many jobs of about the same size, or into more jobs if they would
+                  otherwise be larger than the batch size of the call (such as
+                  uECC_VERIFY_BATCH_SIZE).
+*/
+void uECC_set_executor(uECC_Executor executor, unsigned num_threads);
+
+/* uECC_get_executor() function.
+
+Returns the function that batch calls use to run their jobs, or 0 if they run on the calling
+thread.
+*/
+uECC_Executor uECC_get_executor(void);
+
 /* uECC_curve_private_key_size() function.
 
 Returns the size of a private key for the curve in bytes.
@@ -165,6 +394,26 @@ Returns 1 if the key pair was generated successfully, 0 if an error occurred.
 */
 int uECC_make_key(uint8_t *public_key, uint8_t *private_key, uECC_Curve curve);
 
+/* uECC_make_key_batch() function.
+Create several public/private key pairs. Gives the same kind of key pairs as uECC_make_key(), but
+draws the random values of up to uECC_MAKE_KEY_BATCH_SIZE key pairs with a single call to the RNG
+function, computes their public keys without normalizing them, and then normalizes all of them
+with a single field inversion.
+
+Outputs:
+    public_keys  - Will be filled in with the count public keys, one after another (each is
+                   2 * the curve size).
+    private_keys - Will be filled in with the count private keys, one after another (each is as
+                   long as the curve order). With uECC_VLI_NATIVE_LITTLE_ENDIAN, each private key
+                   is padded with zeros to a whole number of words (uECC_WORD_SIZE bytes).
+
+Returns 1 if all the key pairs were generated successfully, 0 if an error occurred.
+*/
+int uECC_make_key_batch(uint8_t *public_keys,
+                        uint8_t *private_keys,
+                        unsigned count,
+                        uECC_Curve curve);
+
 /* uECC_shared_secret() function.
 Compute a shared secret given your secret key and someone else's public key. If the public key
 is not from a trusted source and has not been previously verified, you should verify it first
@@ -187,6 +436,32 @@ int uECC_shared_secret(const uint8_t *public_key,
                        uint8_t *secret,
                        uECC_Curve curve);
 
+/* uECC_shared_secret_x() function.
+Compute the same shared secret as uECC_shared_secret(), given only the x coordinate of the
+other party's public key. This works directly on compressed public keys (as produced by
+uECC_compress()): pass a pointer to the byte after the compression prefix. The y coordinate is
+never computed, which saves the modular square root of uECC_decompress().
+The x coordinate is checked to belong to a point on the curve, so there is no need to call
+uECC_valid_public_key() first.
+
+Inputs:
+    public_x    - The x coordinate of the public key of the remote party. Must be the same size
+                  as the curve size; for example, if the curve is secp256r1, public_x must be
+                  32 bytes long.
+    private_key - Your private key.
+
+Outputs:
+    secret - Will be filled in with the shared secret value. Must be the same size as the
+             curve size.
+
+Returns 1 if the shared secret was generated successfully, 0 if an error occurred (including
+if public_x is not the x coordinate of a point on the curve).
+*/
+int uECC_shared_secret_x(const uint8_t *public_x,
+                         const uint8_t *private_key,
+                         uint8_t *secret,
+                         uECC_Curve curve);
+
 #if uECC_SUPPORT_COMPRESSED_POINT
 /* uECC_compress() function.
 Compress a public key.
@@ -360,6 +635,336 @@ int uECC_verify(const uint8_t *public_key,
                 const uint8_t *signature,
                 uECC_Curve curve);
 
+/* uECC_PreparedKey structure.
+A public key that has been decoded and validated once by uECC_prepare_key(), together with a
+table of its odd multiples, so that repeated calls to uECC_verify_prepared() and
+uECC_shared_secret_prepared() with the same key do not redo that work. The members are private;
+a uECC_PreparedKey can be copied with memcpy(), and needs no cleanup.
+*/
+typedef struct uECC_PreparedKey {
+    uECC_Curve curve;
+    uint64_t table[(1 << (uECC_PREPARED_WINDOW - 2)) * 2 * uECC_MAX_COORDINATE_BYTES / 8];
+} uECC_PreparedKey;
+
+/* uECC_prepare_key() function.
+Prepare a public key for use with uECC_verify_prepared() and uECC_shared_secret_prepared().
+
+Inputs:
+    public_key - The public key to prepare.
+
+Outputs:
+    prepared - Will be filled in with the prepared key.
+
+Returns 1 if the key was prepared successfully, 0 if public_key is not a valid public key.
+*/
+int uECC_prepare_key(const uint8_t *public_key, uECC_PreparedKey *prepared, uECC_Curve curve);
+
+/* uECC_verify_prepared() function.
+Verify an ECDSA signature with a prepared public key. Gives the same result as uECC_verify()
+with the public key that was passed to uECC_prepare_key().
+
+Inputs:
+    prepared     - The signer's prepared public key.
+    message_hash - The hash of the signed data.
+    hash_size    - The size of message_hash in bytes.
+    signature    - The signature value.
+
+Returns 1 if the signature is valid, 0 if it is invalid.
+*/
+int uECC_verify_prepared(const uECC_PreparedKey *prepared,
+                         const uint8_t *message_hash,
+                         unsigned hash_size,
+                         const uint8_t *signature);
+
+/* uECC_verify_batch() function.
+Verify several ECDSA signatures at once. Gives the same result for each signature as
+uECC_verify(), but checks a random linear combination of the verification equations with a
+single multi-scalar multiplication, which is faster than verifying the signatures one at a time.
+If that check fails, the batch is split in halves until the invalid signatures are found.
+
+The combined check needs the point R = k * G of each signature, which is recovered from r and the
+recovery id of the signature. A plain ECDSA signature does not determine the sign of the y
+coordinate of R, and the combined check fails whenever one of them is guessed wrong, so only
+signatures with a recovery id are combined. If recovery_ids is 0, every signature is checked with
+uECC_verify(), and the call is no faster than verifying the signatures one at a time. The recovery
+ids must come from the signer, which knows R; uECC_sign() does not output them.
+
+Inputs:
+    public_keys    - The count public keys, one after another.
+    message_hashes - The count message hashes, one after another (hash_size bytes each).
+    hash_size      - The size of each message hash in bytes.
+    signatures     - The count signatures, one after another.
+    recovery_ids   - Optional (may be 0). The recovery id of each signature: bit 0 is the parity of
+                     the y coordinate of R, and bit 1 is set if the x coordinate of R is r + n.
+                     A wrong recovery id makes the call slower, but does not change its result.
+    count          - The number of signatures.
+
+Outputs:
+    results - Optional (may be 0). results[i] is set to 1 if signature i is valid, 0 otherwise.
+
+Returns 1 if all the signatures are valid, 0 if any of them is invalid.
+*/
+int uECC_verify_batch(const uint8_t *public_keys,
+                      const uint8_t *message_hashes,
+                      unsigned hash_size,
+                      const uint8_t *signatures,
+                      const uint8_t *recovery_ids,
+                      unsigned count,
+                      uint8_t *results,
+                      uECC_Curve curve);
+
+/* uECC_sign_batch() function.
+Generate ECDSA signatures of several message hashes with the same private key. Gives the same
+kind of signatures as uECC_sign(), but computes the points R = k * G of up to
+uECC_SIGN_BATCH_SIZE signatures without normalizing them, and then normalizes all of them with a
+single field inversion and finds all the values 1 / k with a single inversion mod n. The private
+key is only decoded once.
+
+Usage: Compute a hash of the data you wish to sign for each signature, and pass the hashes to
+uECC_sign_batch() along with your private key.
+
+Inputs:
+    private_key    - Your private key.
+    message_hashes - The count message hashes, one after another (hash_size bytes each).
+    hash_size      - The size of each message hash in bytes.
+    count          - The number of signatures.
+
+Outputs:
+    signatures - Will be filled in with the count signatures, one after another (each is twice
+                 the curve size).
+
+Returns 1 if all the signatures were generated successfully, 0 if an error occurred.
+*/
+int uECC_sign_batch(const uint8_t *private_key,
+                    const uint8_t *message_hashes,
+                    unsigned hash_size,
+                    unsigned count,
+                    uint8_t *signatures,
+                    uECC_Curve curve);
+
+/* uECC_shared_secret_batch() function.
+Compute shared secrets between your private key and several public keys. Gives the same
+shared secret for each valid public key as uECC_shared_secret(), but decodes the private key
+only once, runs the point multiplications of up to uECC_SHARED_SECRET_BATCH_SIZE public keys
+together (in the vector lanes of the AVX-512 IFMA or AVX2 engine where available), and brings
+their results to affine coordinates with shared inversions. Each public key is checked with
+uECC_valid_public_key() first; an invalid public key only fails its own shared secret.
+
+Inputs:
+    public_keys - The count public keys of the remote parties, one after another (each is twice
+                  the curve size).
+    private_key - Your private key.
+    count       - The number of public keys.
+
+Outputs:
+    secrets - Will be filled in with the count shared secrets, one after another (each is the
+              curve size). The shared secrets of invalid public keys are left unchanged.
+    results - Optional (may be 0). results[i] is set to 1 if shared secret i was computed,
+              0 otherwise.
+
+Returns 1 if all the shared secrets were computed successfully, 0 if any of them failed.
+*/
+int uECC_shared_secret_batch(const uint8_t *public_keys,
+                             const uint8_t *private_key,
+                             unsigned count,
+                             uint8_t *secrets,
+                             uint8_t *results,
+                             uECC_Curve curve);
+
+#if uECC_NONCE_POOL_SIZE
+
+/* uECC_NoncePool structure.
+A pool of precomputed signing nonces for uECC_sign_from_pool(). Each nonce holds the r value of
+a signature and 1 / k for its random k; neither depends on the message or the private key, so
+they can be computed ahead of time (for example in an idle thread) by uECC_nonce_pool_refill(),
+leaving only a few multiplications mod n to uECC_sign_from_pool(). Each nonce is used for one
+signature only, and is wiped from the pool when it is taken.
+
+With GCC or Clang, any number of threads may refill a pool and sign from it at the same time,
+without locks. With other compilers, a pool must only be used by one thread at a time. The
+members are private.
+*/
+typedef struct uECC_NoncePool {
+    uECC_Curve curve;
+    unsigned head;
+    unsigned tail;
+    unsigned sequence[uECC_NONCE_POOL_SIZE];
+    uint64_t nonces[uECC_NONCE_POOL_SIZE][2 * uECC_MAX_COORDINATE_BYTES / 8];
+} uECC_NoncePool;
+
+/* uECC_nonce_pool_init() function.
+Initialize an empty nonce pool for the given curve. Can also be called on an initialized pool
+(while no other thread uses it) to discard and wipe its nonces.
+
+Outputs:
+    pool - The pool to initialize.
+*/
+void uECC_nonce_pool_init(uECC_NoncePool *pool, uECC_Curve curve);
+
+/* uECC_nonce_pool_refill() function.
+Add nonces to a nonce pool. Computes up to max_count nonces (but no more than the pool has room
+for, and no more than uECC_SIGN_BATCH_SIZE at a time) with a single field inversion and a single
+inversion mod n, as uECC_sign_batch() does. Call it repeatedly, for example from an idle thread,
+until it returns 0 to fill the pool.
+
+Inputs:
+    pool      - The pool to refill.
+    max_count - The largest number of nonces to add.
+
+Returns the number of nonces that were added, 0 if the pool is full (or the RNG failed).
+*/
+unsigned uECC_nonce_pool_refill(uECC_NoncePool *pool, unsigned max_count);
+
+/* uECC_nonce_pool_available() function.
+Returns the number of nonces in a nonce pool.
+*/
+unsigned uECC_nonce_pool_available(const uECC_NoncePool *pool);
+
+/* uECC_sign_from_pool() function.
+Generate an ECDSA signature with a nonce taken from a nonce pool. Gives the same kind of
+signature as uECC_sign(), with the curve of the pool. If the pool is empty, the signature is
+generated by uECC_sign().
+
+Inputs:
+    pool         - The pool to take the nonce from.
+    private_key  - Your private key.
+    message_hash - The hash of the message to sign.
+    hash_size    - The size of message_hash in bytes.
+
+Outputs:
+    signature - Will be filled in with the signature value. Must be at least 2 * curve size long.
+
+Returns 1 if the signature generated successfully, 0 if an error occurred.
+*/
+int uECC_sign_from_pool(uECC_NoncePool *pool,
+                        const uint8_t *private_key,
+                        const uint8_t *message_hash,
+                        unsigned hash_size,
+                        uint8_t *signature);
+
+#endif /* uECC_NONCE_POOL_SIZE */
+
+#if uECC_KEY_POOL_SIZE
+
+/* uECC_Watermark_Function type
+Called by uECC_key_pool_take() when a key pool runs low, with the context that was passed to
+uECC_key_pool_init(). It is called from the thread that took the key, so it should only signal
+the thread that refills the pool, rather than refill the pool itself.
+*/
+typedef void (*uECC_Watermark_Function)(void *context);
+
+/* uECC_KeyPool structure.
+A pool of pre-generated key pairs, such as the ephemeral keys of ECDH handshakes. The key pairs
+are generated ahead of time (for example in an idle thread) by uECC_key_pool_refill(), so that
+uECC_key_pool_take() only needs to copy one out. Each key pair is handed out once, and is wiped
+from the pool when it is taken.
+
+With GCC or Clang, any number of threads may refill a pool and take keys from it at the same
+time, without locks. With other compilers, a pool must only be used by one thread at a time. The
+members are private.
+*/
+typedef struct uECC_KeyPool {
+    uECC_Curve curve;
+    unsigned head;
+    unsigned tail;
+    unsigned misses;
+    unsigned low_watermark;
+    uECC_Watermark_Function callback;
+    void *context;
+    unsigned sequence[uECC_KEY_POOL_SIZE];
+    uint8_t keys[uECC_KEY_POOL_SIZE][3 * uECC_MAX_COORDINATE_BYTES];
+} uECC_KeyPool;
+
+/* uECC_key_pool_init() function.
+Initialize an empty key pool for the given curve. Can also be called on an initialized pool
+(while no other thread uses it) to discard and wipe its key pairs.
+
+Inputs:
+    curve         - The curve of the key pairs.
+    low_watermark - callback is called each time a key is taken and leaves this many key pairs or
+                    fewer in the pool.
+    callback      - Optional (may be 0). The function to call when the pool runs low.
+    context       - The argument to pass to callback.
+
+Outputs:
+    pool - The pool to initialize.
+*/
+void uECC_key_pool_init(uECC_KeyPool *pool,
+                        uECC_Curve curve,
+                        unsigned low_watermark,
+                        uECC_Watermark_Function callback,
+                        void *context);
+
+/* uECC_key_pool_refill() function.
+Add key pairs to a key pool. Generates up to max_count key pairs (but no more than the pool has
+room for, and no more than uECC_MAKE_KEY_BATCH_SIZE at a time) as uECC_make_key_batch() does.
+Call it repeatedly, for example from an idle thread, until it returns 0 to fill the pool.
+
+Inputs:
+    pool      - The pool to refill.
+    max_count - The largest number of key pairs to add.
+
+Returns the number of key pairs that were added, 0 if the pool is full (or the RNG failed).
+*/
+unsigned uECC_key_pool_refill(uECC_KeyPool *pool, unsigned max_count);
+
+/* uECC_key_pool_available() function.
+Returns the number of key pairs in a key pool.
+*/
+unsigned uECC_key_pool_available(const uECC_KeyPool *pool);
+
+/* uECC_key_pool_misses() function.
+Returns the number of times uECC_key_pool_take() found the pool empty.
+*/
+unsigned uECC_key_pool_misses(const uECC_KeyPool *pool);
+
+/* uECC_key_pool_take() function.
+Take a key pair from a key pool. If the pool is empty, the key pair is generated by
+uECC_make_key() instead, and counted as a miss. Calls the pool's callback if this leaves the pool
+at or below its low watermark.
+
+Inputs:
+    pool - The pool to take the key pair from.
+
+Outputs:
+    public_key  - Will be filled in with the public key. Must be at least 2 * the curve size
+                  (in bytes) long.
+    private_key - Will be filled in with the private key. Must be as long as the curve order.
+
+Returns 1 if a key pair was taken or generated, 0 if an error occurred.
+*/
+int uECC_key_pool_take(uECC_KeyPool *pool, uint8_t *public_key, uint8_t *private_key);
+
+/* uECC_key_pool_release() function.
+Wipe a private key taken from a key pool once it is no longer needed, in a way that the compiler
+cannot leave out.
+
+Inputs:
+    pool        - The pool that the key pair was taken from.
+    private_key - The private key to wipe.
+*/
+void uECC_key_pool_release(const uECC_KeyPool *pool, uint8_t *private_key);
+
+#endif /* uECC_KEY_POOL_SIZE */
+
+/* uECC_shared_secret_prepared() function.
+Compute a shared secret with a prepared public key. Gives the same result as
+uECC_shared_secret() with the public key that was passed to uECC_prepare_key().
+
+Inputs:
+    prepared    - The prepared public key of the remote party.
+    private_key - Your private key.
+
+Outputs:
+    secret - Will be filled in with the shared secret value. Must be the same size as the
+             curve size; for example, if the curve is secp256r1, secret must be 32 bytes long.
+
+Returns 1 if the shared secret was generated successfully, 0 if an error occurred.
+*/
+int uECC_shared_secret_prepared(const uECC_PreparedKey *prepared,
+                                const uint8_t *private_key,
+                                uint8_t *secret);
+
 #ifdef __cplusplus
 } /* end of extern "C" */
 #endif
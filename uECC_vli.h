@@ -157,6 +157,31 @@ void uECC_point_mult(uECC_word_t *result,
                      const uECC_word_t *scalar,
                      uECC_Curve curve);
 
+/* Computes result = scalars[0] * points[0] + ... + scalars[count - 1] * points[count - 1].
+   points holds the count points one after the other, and scalars holds the count scalars one
+   after the other (curve->num_n_words long each). A few points are handled by interleaving
+   windowed non-adjacent forms (Straus), and many points by Pippenger's bucket method, which is
+   much cheaper than count separate calls to uECC_point_mult(). This is not constant time, so
+   the scalars must not be secret. Returns 0 if the result is the point at infinity (result is
+   then set to 0), 1 otherwise. */
+int uECC_point_multi_mult(uECC_word_t *result,
+                          const uECC_word_t *points,
+                          const uECC_word_t *scalars,
+                          unsigned count,
+                          uECC_Curve curve);
+
+/* Computes results[i] = scalars[i] * points[i] for i < count, with points, scalars and results
+   laid out as for uECC_point_multi_mult() (results may be the same array as points). This is
+   constant time, like uECC_point_mult(). On x86-64 processors with AVX2 (or AVX-512 IFMA),
+   the points are multiplied four (or eight) at a time in the lanes of vector registers, which
+   is faster than separate calls to uECC_point_mult() for secp256r1 and secp256k1. Other points
+   are multiplied one at a time, with their final inversions combined. */
+void uECC_point_mult_batch(uECC_word_t *results,
+                           const uECC_word_t *points,
+                           const uECC_word_t *scalars,
+                           unsigned count,
+                           uECC_Curve curve);
+
 /* Generates a random integer in the range 0 < random < top.
    Both random and top have num_words words. */
 int uECC_generate_random_int(uECC_word_t *random,